@@ -0,0 +1,29 @@
+#ifndef ARITHMETIC_H
+#define ARITHMETIC_H
+
+#include <cmath>
+
+// The two products every shape metric is built from. Where the target has a fast fused
+// multiply-add the fusing is written out, so the rounding does not depend on whether and
+// how the compiler contracts the expression (GCC only does at -O2 and above); SIMD code
+// that mirrors these gets the same bits at any optimization level.
+
+// x1*y2 - x2*y1
+inline double cross_product(double x1, double y1, double x2, double y2) {
+#ifdef __FP_FAST_FMA
+    return std::fma(x1, y2, -(x2*y1));
+#else
+    return x1*y2 - x2*y1;
+#endif
+}
+
+// dx*dx + dy*dy
+inline double squared_norm(double dx, double dy) {
+#ifdef __FP_FAST_FMA
+    return std::fma(dx, dx, dy*dy);
+#else
+    return dx*dx + dy*dy;
+#endif
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <algorithm>
+
+#include "shapes.h"
+#include "polygon_batch.h"
+
+// Computes the area and perimeter of random convex polygons through Polygon and through
+// PolygonBatch:
+//     bench_polygon_batch [polygons] [seed]
+// Every result must come out bit-for-bit equal; the count of those that do not is printed
+// and makes the exit code 1. Build it both without and with AVX2, e.g.
+//     g++ -std=c++17 -O2 bench_polygon_batch.cpp
+//     g++ -std=c++17 -O2 -mavx2 -mfma bench_polygon_batch.cpp
+// to check the scalar fallback and the four-lane kernels.
+
+// Sorted random angles on a circle, far from the origin half of the time so that the
+// cross products cancel.
+std::vector<double> convex_coords(int n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit (0, 1);
+    std::vector<double> angles;
+    for (int i = 0; i < n; ++i) {
+        angles.push_back(2*M_PI*unit(rng));
+    }
+    std::sort(angles.begin(), angles.end());
+    double radius = 1 + 9*unit(rng);
+    double shift = rng() % 2 ? 1e4*unit(rng) : 0;
+    std::vector<double> coords;
+    for (double a : angles) {
+        coords.push_back(shift + radius*std::cos(a));
+        coords.push_back(shift + radius*std::sin(a));
+    }
+    return coords;
+}
+
+template<class F>
+double best_ns_per_polygon(std::size_t polygons, F f) {
+    double best = 0;
+    for (int pass = 0; pass < 5; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (pass == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best*1e9 / polygons;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::mt19937_64 rng (argc > 2 ? std::stoull(argv[2]) : 1);
+
+    std::vector<Polygon> polygons;
+    PolygonBatch batch;
+    while (int(polygons.size()) < count) {
+        // mostly small, now and then one long enough for the lanes to drift apart
+        int n = rng() % 50 ? 3 + rng() % 14 : 3 + rng() % 200;
+        try {
+            polygons.emplace_back(convex_coords(n, rng));
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+        batch.add(polygons.back());
+    }
+
+    std::vector<double> areas (polygons.size());
+    std::vector<double> perimeters (polygons.size());
+    double polygon_area_ns = best_ns_per_polygon(polygons.size(), [&]() {
+        for (std::size_t i = 0; i < polygons.size(); ++i) {
+            areas[i] = polygons[i].area();
+        }
+    });
+    double polygon_perimeter_ns = best_ns_per_polygon(polygons.size(), [&]() {
+        for (std::size_t i = 0; i < polygons.size(); ++i) {
+            perimeters[i] = polygons[i].perimeter();
+        }
+    });
+    std::vector<double> batch_areas (polygons.size());
+    std::vector<double> batch_perimeters (polygons.size());
+    double batch_area_ns = best_ns_per_polygon(polygons.size(), [&]() {
+        batch.areas(batch_areas.data());
+    });
+    double batch_perimeter_ns = best_ns_per_polygon(polygons.size(), [&]() {
+        batch.perimeters(batch_perimeters.data());
+    });
+
+    int area_differ = 0;
+    int perimeter_differ = 0;
+    for (std::size_t i = 0; i < polygons.size(); ++i) {
+        area_differ += batch_areas[i] != areas[i];
+        perimeter_differ += batch_perimeters[i] != perimeters[i];
+    }
+
+#ifdef __AVX2__
+    const char* kernels = "AVX2";
+#else
+    const char* kernels = "scalar";
+#endif
+    std::printf("polygons %zu, %s kernels\n", polygons.size(), kernels);
+    std::printf("           differ  polygon ns  batch ns\n");
+    std::printf("area       %6d  %10.1f  %8.1f\n", area_differ, polygon_area_ns, batch_area_ns);
+    std::printf("perimeter  %6d  %10.1f  %8.1f\n", perimeter_differ, polygon_perimeter_ns, batch_perimeter_ns);
+    return area_differ || perimeter_differ ? 1 : 0;
+}
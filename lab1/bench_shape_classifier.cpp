@@ -0,0 +1,203 @@
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "shapes.h"
+#include "shape_classifier.h"
+
+// Checks classify and classify_all against building the shapes of shapes.h, most specific
+// first, until a constructor does not throw:
+//     bench_shape_classifier [rings] [seed]
+// Over a mix of random, convex, regular, triangle, trapezoid and degenerate rings the kind,
+// area and perimeter must come out bit-for-bit equal; the number of rings that do not is
+// printed with the time per ring of each way, and makes the exit code 1.
+
+ShapeInfo construct(const std::vector<double>& coords) {
+    ShapeInfo info;
+    info.n_points = coords.size() / 2;
+    auto take = [&](const Polygon& polygon, ShapeKind kind) {
+        info.kind = kind;
+        info.area = polygon.area();
+        info.perimeter = polygon.perimeter();
+    };
+    try {
+        take(RegularPolygon(coords), ShapeKind::RegularPolygon);
+        return info;
+    } catch (const std::invalid_argument&) {}
+    try {
+        take(Triangle(coords), ShapeKind::Triangle);
+        return info;
+    } catch (const std::invalid_argument&) {}
+    try {
+        take(Trapezoid(coords), ShapeKind::Trapezoid);
+        return info;
+    } catch (const std::invalid_argument&) {}
+    try {
+        take(Polygon(coords), ShapeKind::Polygon);
+        return info;
+    } catch (const std::invalid_argument&) {}
+    return info;
+}
+
+std::vector<double> regular(int n, double radius, double phase, std::mt19937_64& rng, double noise) {
+    std::normal_distribution<double> jitter (0, noise);
+    std::vector<double> coords;
+    for (int i = 0; i < n; ++i) {
+        coords.push_back(radius*std::cos(phase + 2*M_PI*i/n) + jitter(rng));
+        coords.push_back(radius*std::sin(phase + 2*M_PI*i/n) + jitter(rng));
+    }
+    return coords;
+}
+
+std::vector<double> convex(int n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> angle (0, 2*M_PI);
+    std::vector<double> angles;
+    for (int i = 0; i < n; ++i) {
+        angles.push_back(angle(rng));
+    }
+    std::sort(angles.begin(), angles.end());
+    if (rng() % 2) {
+        std::reverse(angles.begin(), angles.end());
+    }
+    std::vector<double> coords;
+    for (double a : angles) {
+        coords.push_back(5*std::cos(a));
+        coords.push_back(5*std::sin(a));
+    }
+    return coords;
+}
+
+// Two parallel sides of different lengths, tilted by a random angle.
+std::vector<double> trapezoid(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit (0, 1);
+    double bottom = 1 + 9*unit(rng);
+    double top = bottom*(0.2 + 0.6*unit(rng));
+    double height = 1 + 5*unit(rng);
+    double shift = (bottom - top)*unit(rng);
+    double c = std::cos(2*M_PI*unit(rng));
+    double s = std::sin(2*M_PI*unit(rng));
+    std::vector<double> local {0, 0, bottom, 0, shift + top, height, shift, height};
+    std::vector<double> coords;
+    for (std::size_t i = 0; i < local.size(); i += 2) {
+        coords.push_back(c*local[i] - s*local[i+1]);
+        coords.push_back(s*local[i] + c*local[i+1]);
+    }
+    return coords;
+}
+
+std::vector<double> mixed_ring(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit (0, 1);
+    std::uniform_real_distribution<double> coord (-10, 10);
+    int n = 3 + rng() % 10;
+    std::vector<double> coords;
+    switch (rng() % 8) {
+    case 0:
+        for (int i = 0; i < 2*n; ++i) {
+            coords.push_back(coord(rng));
+        }
+        break;
+    case 1:
+        coords = convex(n, rng);
+        break;
+    case 2:
+        coords = regular(n, 1 + 9*unit(rng), 2*M_PI*unit(rng), rng, 0);
+        break;
+    case 3:
+        coords = regular(n, 1 + 9*unit(rng), 2*M_PI*unit(rng), rng, 0.002);
+        break;
+    case 4:
+        coords = convex(3, rng);
+        break;
+    case 5:
+        coords = trapezoid(rng);
+        break;
+    case 6:
+        // a repeated point
+        coords = regular(n, 3, 0, rng, 0);
+        coords.insert(coords.begin() + 2*(rng() % n), {coords[0], coords[1]});
+        break;
+    case 7:
+        // an odd number of coordinates
+        coords = convex(n, rng);
+        coords.pop_back();
+        break;
+    }
+    return coords;
+}
+
+// Metrics only count for valid polygons.
+bool same(const ShapeInfo& a, const ShapeInfo& b) {
+    if (a.kind == ShapeKind::Invalid || b.kind == ShapeKind::Invalid) {
+        return a.kind == b.kind;
+    }
+    return a.kind == b.kind && a.n_points == b.n_points && a.area == b.area && a.perimeter == b.perimeter;
+}
+
+template<class F>
+double best_ns_per_ring(std::size_t rings, F f) {
+    double best = 0;
+    for (int pass = 0; pass < 3; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (pass == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best*1e9 / rings;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::mt19937_64 rng (argc > 2 ? std::stoull(argv[2]) : 1);
+
+    std::vector<std::vector<double>> rings;
+    for (int i = 0; i < count; ++i) {
+        rings.push_back(mixed_ring(rng));
+    }
+
+    std::vector<ShapeInfo> constructed (rings.size());
+    std::vector<ShapeInfo> classified (rings.size());
+    std::vector<ShapeInfo> batch (rings.size());
+    double construct_ns = best_ns_per_ring(rings.size(), [&]() {
+        for (std::size_t i = 0; i < rings.size(); ++i) {
+            constructed[i] = construct(rings[i]);
+        }
+    });
+    double classify_ns = best_ns_per_ring(rings.size(), [&]() {
+        for (std::size_t i = 0; i < rings.size(); ++i) {
+            classified[i] = classify(rings[i]);
+        }
+    });
+    double classify_all_ns = best_ns_per_ring(rings.size(), [&]() {
+        classify_all(rings, batch.data());
+    });
+
+    int kinds[5] = {};
+    int classify_differ = 0;
+    int classify_all_differ = 0;
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        ++kinds[int(constructed[i].kind)];
+        if (!same(classified[i], constructed[i]) && ++classify_differ <= 5) {
+            std::printf("ring %zu: classify says %s, the constructors %s\n", i, kind_name(classified[i].kind),
+                        kind_name(constructed[i].kind));
+        }
+        classify_all_differ += !same(batch[i], constructed[i]);
+    }
+
+    std::printf("rings %zu:", rings.size());
+    for (ShapeKind kind : {ShapeKind::Invalid, ShapeKind::Polygon, ShapeKind::Triangle, ShapeKind::Trapezoid,
+                           ShapeKind::RegularPolygon}) {
+        std::printf(" %d %s,", kinds[int(kind)], kind_name(kind));
+    }
+    std::printf("\n");
+    std::printf("              differ  ns per ring\n");
+    std::printf("constructors          %11.1f\n", construct_ns);
+    std::printf("classify      %6d  %11.1f\n", classify_differ, classify_ns);
+    std::printf("classify_all  %6d  %11.1f\n", classify_all_differ, classify_all_ns);
+    return classify_differ || classify_all_differ ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "shapes.h"
+#include "static_shapes.h"
+
+// Sums areas and lengths over a mixed collection of lines and polygons, once through the
+// virtual classes of shapes.h and once through static_shapes::AnyShape:
+//     bench_static_shapes [shapes] [seed]
+// Both sums must come out bit-for-bit equal.
+
+std::vector<double> regular(int n, double radius, double phase) {
+    std::vector<double> coords;
+    for (int i = 0; i < n; ++i) {
+        coords.push_back(radius*std::cos(phase + 2*M_PI*i/n));
+        coords.push_back(radius*std::sin(phase + 2*M_PI*i/n));
+    }
+    return coords;
+}
+
+template<class F>
+double best_ns_per_shape(std::size_t shapes, F f, double& result) {
+    double best = 0;
+    for (int pass = 0; pass < 5; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        result = f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (pass == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best*1e9 / shapes;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::mt19937_64 rng (argc > 2 ? std::stoull(argv[2]) : 1);
+    std::uniform_real_distribution<double> unit (0, 1);
+
+    std::vector<std::unique_ptr<Line>> lines;
+    std::vector<std::unique_ptr<Polygon>> polygons;
+    std::vector<static_shapes::AnyShape> shapes;
+    for (int i = 0; i < count; ++i) {
+        int n = 3 + rng() % 10;
+        std::vector<double> coords = regular(n, 1 + 9*unit(rng), 2*M_PI*unit(rng));
+        switch (rng() % 4) {
+        case 0:
+            lines.emplace_back(new Line(coords));
+            shapes.emplace_back(static_shapes::Line(*lines.back()));
+            break;
+        case 1:
+            lines.emplace_back(new ClosedLine(coords));
+            shapes.emplace_back(static_shapes::ClosedLine(*lines.back()));
+            break;
+        case 2:
+            polygons.emplace_back(new RegularPolygon(coords));
+            shapes.emplace_back(static_shapes::RegularPolygon(coords));
+            break;
+        default:
+            polygons.emplace_back(new Polygon(coords));
+            shapes.emplace_back(static_shapes::Polygon(coords));
+            break;
+        }
+    }
+
+    double virtual_length, static_length, virtual_area, static_area;
+    double virtual_length_ns = best_ns_per_shape(shapes.size(), [&]() {
+        double sum = 0;
+        for (const auto& line : lines) {
+            sum += line->length();
+        }
+        for (const auto& polygon : polygons) {
+            sum += polygon->perimeter();
+        }
+        return sum;
+    }, virtual_length);
+    double virtual_area_ns = best_ns_per_shape(shapes.size(), [&]() {
+        double sum = 0;
+        for (const auto& polygon : polygons) {
+            sum += polygon->area();
+        }
+        return sum;
+    }, virtual_area);
+    double static_length_ns = best_ns_per_shape(shapes.size(), [&]() {
+        return static_shapes::total_length(shapes);
+    }, static_length);
+    double static_area_ns = best_ns_per_shape(shapes.size(), [&]() {
+        return static_shapes::total_area(shapes);
+    }, static_area);
+
+    // the static sums run in collection order, so compare per shape instead
+    int differ = 0;
+    std::size_t l = 0;
+    std::size_t p = 0;
+    for (const static_shapes::AnyShape& shape : shapes) {
+        if (shape.index() < 2) {
+            differ += static_shapes::length(shape) != lines[l++]->length();
+        } else {
+            const Polygon& polygon = *polygons[p++];
+            differ += static_shapes::length(shape) != polygon.perimeter();
+            differ += static_shapes::area(shape) != polygon.area();
+        }
+    }
+
+    std::printf("shapes %zu, results differing %d\n", shapes.size(), differ);
+    std::printf("          virtual ns  static ns  virtual sum   static sum\n");
+    std::printf("length    %10.1f  %9.1f  %11.4f  %11.4f\n", virtual_length_ns, static_length_ns, virtual_length, static_length);
+    std::printf("area      %10.1f  %9.1f  %11.4f  %11.4f\n", virtual_area_ns, static_area_ns, virtual_area, static_area);
+}
@@ -0,0 +1,228 @@
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <iostream>
+
+#include "shapes.h"
+
+// Compares the cross/dot validators of validation.h with the atan2 ones they replaced:
+//     bench_validation [rings] [seed]
+// Every family of rings is checked by both, and the number of disagreements and the time
+// per ring are printed for each. Rings with a midpoint on a side are always rejected now;
+// the atan2 check accepted them whenever rounding gave the straight turn the sign of the
+// others, so they show up as disagreements.
+
+bool legacy_is_valid_polygon(const ClosedLine& line) {
+    int n = line.n_points();
+    if (n < 3) {
+        return false;
+    }
+    Point old_point = line[n-2];
+    Point new_point = line[n-1];
+    double new_dir = std::atan2(new_point.y()-old_point.y(), new_point.x()-old_point.x());
+    double old_dir;
+    double angle_sum = 0;
+    int orient;
+    for (int i = 0; i < n; ++i) {
+        old_point = new_point;
+        old_dir = new_dir;
+        new_point = line[i];
+        new_dir = std::atan2(new_point.y()-old_point.y(), new_point.x()-old_point.x());
+        if (old_point == new_point) {
+            return false;
+        }
+        double angle = new_dir - old_dir;
+        if (angle <= -M_PI) {
+            angle += 2*M_PI;
+        }
+        else if (angle > M_PI) {
+            angle -= 2*M_PI;
+        }
+        if (i == 0) {
+            if (double_eq(angle, 0)) {
+                return false;
+            }
+            orient = angle > 0 ? 1 : -1;
+        }
+        else {
+            if (orient*angle <= 0) {
+                return false;
+            }
+        }
+        angle_sum += angle;
+    }
+    return std::abs(std::round(angle_sum / (2*M_PI))) == 1;
+}
+
+bool legacy_is_valid_regular_polygon(const ClosedLine& line) {
+    int n = line.n_points();
+    double good_length = line.length() / n;
+    double good_angle = ((n - 2) * M_PI) / n;
+    Point old_point = line[n-2];
+    Point new_point = line[n-1];
+    double new_dir = std::atan2(new_point.y()-old_point.y(), new_point.x()-old_point.x());
+    double old_dir;
+    for (int i = 0; i < n; ++i) {
+        old_point = new_point;
+        old_dir = new_dir;
+        new_point = line[i];
+        new_dir = std::atan2(new_point.y()-old_point.y(), new_point.x()-old_point.x());
+        if (!double_eq(old_point.dist(new_point), good_length)) {
+            return false;
+        }
+        double angle = new_dir-old_dir;
+        if (angle <= -M_PI) {
+            angle += 2*M_PI;
+        }
+        else if (angle > M_PI) {
+            angle -= 2 * M_PI;
+        }
+        if (!double_eq(M_PI-std::abs(angle), good_angle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Point> regular(int n, double radius, double phase, int step, std::mt19937_64& rng, double noise) {
+    std::normal_distribution<double> jitter (0, noise);
+    std::vector<Point> points;
+    for (int i = 0; i < n; ++i) {
+        double a = phase + 2*M_PI*step*i/n;
+        points.emplace_back(radius*std::cos(a) + jitter(rng), radius*std::sin(a) + jitter(rng));
+    }
+    return points;
+}
+
+std::vector<Point> random_ring(int n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> coord (-10, 10);
+    std::vector<Point> points;
+    for (int i = 0; i < n; ++i) {
+        points.emplace_back(coord(rng), coord(rng));
+    }
+    return points;
+}
+
+// Convex polygon from sorted random angles on a circle, possibly walked clockwise.
+std::vector<Point> convex_ring(int n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> angle (0, 2*M_PI);
+    std::vector<double> angles;
+    for (int i = 0; i < n; ++i) {
+        angles.push_back(angle(rng));
+    }
+    std::sort(angles.begin(), angles.end());
+    if (rng() % 2) {
+        std::reverse(angles.begin(), angles.end());
+    }
+    std::vector<Point> points;
+    for (double a : angles) {
+        points.emplace_back(5*std::cos(a), 5*std::sin(a));
+    }
+    return points;
+}
+
+enum class Defect {
+    Repeated,
+    Collinear,
+    Spike,
+    Twice,
+};
+
+// A regular polygon with a repeated point, a midpoint inserted on a side, a spike back
+// along a side, or walked around twice.
+std::vector<Point> degenerate_ring(int n, Defect defect, std::mt19937_64& rng) {
+    std::vector<Point> points = regular(n, 3, 0, 1, rng, 0);
+    switch (defect) {
+    case Defect::Repeated:
+        points.insert(points.begin() + rng() % n, points[rng() % n]);
+        break;
+    case Defect::Collinear: {
+        int i = rng() % n;
+        const Point& a = points[i];
+        const Point& b = points[(i+1) % n];
+        points.insert(points.begin() + i + 1, Point((a.x()+b.x())/2, (a.y()+b.y())/2));
+        break;
+    }
+    case Defect::Spike: {
+        int i = rng() % n;
+        points.insert(points.begin() + i + 1, points[(i+n-1) % n]);
+        break;
+    }
+    case Defect::Twice: {
+        std::vector<Point> twice = points;
+        points.insert(points.end(), twice.begin(), twice.end());
+        break;
+    }
+    }
+    return points;
+}
+
+struct Family {
+    std::string name;
+    std::vector<ClosedLine> rings;
+};
+
+template<class Check>
+double seconds_per_ring(const std::vector<ClosedLine>& rings, Check check, int& accepted) {
+    auto start = std::chrono::steady_clock::now();
+    accepted = 0;
+    for (int pass = 0; pass < 5; ++pass) {
+        accepted = 0;
+        for (const ClosedLine& ring : rings) {
+            accepted += check(ring);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (5*rings.size());
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 20000;
+    std::mt19937_64 rng (argc > 2 ? std::stoull(argv[2]) : 1);
+    std::uniform_int_distribution<int> sides (3, 12);
+    std::uniform_real_distribution<double> unit (0, 1);
+
+    std::vector<Family> families {{"random", {}}, {"convex", {}}, {"regular", {}}, {"noisy regular", {}}, {"star", {}},
+                                  {"repeated point", {}}, {"collinear", {}}, {"spike", {}}, {"wound twice", {}}};
+    for (int i = 0; i < count; ++i) {
+        int n = sides(rng);
+        families[0].rings.emplace_back(random_ring(n, rng));
+        families[1].rings.emplace_back(convex_ring(n, rng));
+        families[2].rings.emplace_back(regular(n, 1 + 9*unit(rng), 2*M_PI*unit(rng), 1, rng, 0));
+        families[3].rings.emplace_back(regular(n, 1 + 9*unit(rng), 2*M_PI*unit(rng), 1, rng, 0.002));
+        int m = 5 + 2*(rng() % 4);
+        families[4].rings.emplace_back(regular(m, 5, 2*M_PI*unit(rng), 2, rng, 0));
+        families[5].rings.emplace_back(degenerate_ring(n, Defect::Repeated, rng));
+        families[6].rings.emplace_back(degenerate_ring(n, Defect::Collinear, rng));
+        families[7].rings.emplace_back(degenerate_ring(n, Defect::Spike, rng));
+        families[8].rings.emplace_back(degenerate_ring(n, Defect::Twice, rng));
+    }
+
+    std::cout << "family          check     atan2 ok  cross ok  differ  atan2 ns  cross ns" << std::endl;
+    for (const Family& family : families) {
+        int legacy_polygons, polygons, legacy_regulars, regulars;
+        double legacy_polygon_time = seconds_per_ring(family.rings, legacy_is_valid_polygon, legacy_polygons);
+        double polygon_time = seconds_per_ring(family.rings, [](const ClosedLine& ring) {
+            return is_convex_polygon(ring);
+        }, polygons);
+        double legacy_regular_time = seconds_per_ring(family.rings, legacy_is_valid_regular_polygon, legacy_regulars);
+        double regular_time = seconds_per_ring(family.rings, [](const ClosedLine& ring) {
+            return is_regular_polygon(ring);
+        }, regulars);
+
+        int polygon_diff = 0;
+        int regular_diff = 0;
+        for (const ClosedLine& ring : family.rings) {
+            polygon_diff += legacy_is_valid_polygon(ring) != is_convex_polygon(ring);
+            regular_diff += legacy_is_valid_regular_polygon(ring) != is_regular_polygon(ring);
+        }
+        std::printf("%-15s polygon   %8d  %8d  %6d  %8.1f  %8.1f\n", family.name.c_str(), legacy_polygons,
+                    polygons, polygon_diff, legacy_polygon_time*1e9, polygon_time*1e9);
+        std::printf("%-15s regular   %8d  %8d  %6d  %8.1f  %8.1f\n", family.name.c_str(), legacy_regulars,
+                    regulars, regular_diff, legacy_regular_time*1e9, regular_time*1e9);
+    }
+}
@@ -0,0 +1,255 @@
+#ifndef POLYGON_BATCH_H
+#define POLYGON_BATCH_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "shapes.h"
+#include "arithmetic.h"
+
+// Many polygons in structure-of-arrays form: the vertices of polygon i are
+// x()[offsets()[i]] .. x()[offsets()[i+1]-1], and the same for y().
+//
+// areas() and perimeters() add up every polygon in the same order as Polygon::area() and
+// Polygon::perimeter(), with the products of arithmetic.h, so the results are bit-for-bit
+// the same at any optimization level, with or without FMA; only -ffast-math, which lets
+// the compiler reorder the scalar sums, breaks that. With AVX2 each of the four lanes
+// walks its own polygon, so no sum is reordered, and with FMA the lanes fuse the same
+// products as the scalar code.
+class PolygonBatch {
+public:
+    PolygonBatch() : offsets_(1, 0) {}
+
+    void reserve(std::size_t polygons, std::size_t points) {
+        offsets_.reserve(polygons + 1);
+        x_.reserve(points);
+        y_.reserve(points);
+    }
+
+    void add(const Polygon& polygon) {
+        const ClosedLine& line = polygon.line();
+        for (int i = 0; i < line.n_points(); ++i) {
+            x_.push_back(line[i].x());
+            y_.push_back(line[i].y());
+        }
+        offsets_.push_back(x_.size());
+    }
+
+    // Coordinates as x0, y0, x1, y1, ...; not checked to form a valid polygon.
+    void add(const std::vector<double>& coords) {
+        if (coords.size()%2) {
+            throw std::invalid_argument("odd number of coordinates");
+        }
+        for (std::size_t i = 0; i < coords.size(); i += 2) {
+            x_.push_back(coords[i]);
+            y_.push_back(coords[i+1]);
+        }
+        offsets_.push_back(x_.size());
+    }
+
+    std::size_t size() const {
+        return offsets_.size() - 1;
+    }
+
+    int n_points(std::size_t i) const {
+        return offsets_[i+1] - offsets_[i];
+    }
+
+    const double* x() const {
+        return x_.data();
+    }
+
+    const double* y() const {
+        return y_.data();
+    }
+
+    const std::size_t* offsets() const {
+        return offsets_.data();
+    }
+
+    void areas(double* out) const {
+        run(out, [this](std::size_t begin, int n) {
+            return area(begin, n);
+        }, [this](const std::size_t* offsets, double* out) {
+            areas4(offsets, out);
+        });
+    }
+
+    void perimeters(double* out) const {
+        run(out, [this](std::size_t begin, int n) {
+            return perimeter(begin, n);
+        }, [this](const std::size_t* offsets, double* out) {
+            perimeters4(offsets, out);
+        });
+    }
+
+    std::vector<double> areas() const {
+        std::vector<double> ans (size());
+        areas(ans.data());
+        return ans;
+    }
+
+    std::vector<double> perimeters() const {
+        std::vector<double> ans (size());
+        perimeters(ans.data());
+        return ans;
+    }
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<std::size_t> offsets_;
+
+    double area(std::size_t begin, int n) const {
+        double sum = 0;
+        for (int i = 0; i < n; ++i) {
+            std::size_t a = begin + i;
+            std::size_t b = begin + (i+1 == n ? 0 : i+1);
+            sum += cross_product(x_[a], y_[a], x_[b], y_[b]);
+        }
+        return std::abs(sum)/2;
+    }
+
+    double perimeter(std::size_t begin, int n) const {
+        if (n <= 1) {
+            return 0;
+        }
+        double sum = 0;
+        for (int i = 0; i < n-1; ++i) {
+            sum += dist(begin + i, begin + i+1);
+        }
+        return sum + dist(begin, begin + n-1);
+    }
+
+    double dist(std::size_t a, std::size_t b) const {
+        return std::sqrt(squared_norm(x_[a] - x_[b], y_[a] - y_[b]));
+    }
+
+    // Four neighbouring polygons at a time go to the four-wide kernel, the rest one by one.
+    template<class One, class Four>
+    void run(double* out, One one, Four four) const {
+        std::size_t i = 0;
+#ifdef __AVX2__
+        for (; i + 4 <= size(); i += 4) {
+            four(offsets_.data() + i, out + i);
+        }
+#else
+        (void)four;
+#endif
+        for (; i < size(); ++i) {
+            out[i] = one(offsets_[i], n_points(i));
+        }
+    }
+
+#ifdef __AVX2__
+    // Lane k walks polygon k from offsets[k] to offsets[k+1]; lanes whose polygon has
+    // fewer vertices than step i neither load nor add anything.
+    struct Lanes {
+        __m256i begin;
+        __m256i n;
+        int max_n;
+
+        explicit Lanes(const std::size_t* offsets)
+                : begin(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets)))
+                , n(_mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + 1)), begin))
+                , max_n(0) {
+            for (int k = 0; k < 4; ++k) {
+                max_n = std::max<int>(max_n, offsets[k+1] - offsets[k]);
+            }
+        }
+
+        // all ones in the lanes whose polygon has more than i vertices
+        __m256d active(int i) const {
+            return _mm256_castsi256_pd(_mm256_cmpgt_epi64(n, _mm256_set1_epi64x(i)));
+        }
+
+        // index of vertex i, or of vertex 0 in the lanes where i is one past the last
+        __m256i at(int i) const {
+            __m256i step = _mm256_set1_epi64x(i);
+            __m256i wrap = _mm256_cmpeq_epi64(n, step);
+            return _mm256_add_epi64(begin, _mm256_andnot_si256(wrap, step));
+        }
+    };
+
+    // a*b - c and a*b + c, fused where cross_product() and squared_norm() are
+    static __m256d fmsub(__m256d a, __m256d b, __m256d c) {
+#if defined(__FMA__) && defined(__FP_FAST_FMA)
+        return _mm256_fmsub_pd(a, b, c);
+#else
+        return _mm256_sub_pd(_mm256_mul_pd(a, b), c);
+#endif
+    }
+
+    static __m256d fmadd(__m256d a, __m256d b, __m256d c) {
+#if defined(__FMA__) && defined(__FP_FAST_FMA)
+        return _mm256_fmadd_pd(a, b, c);
+#else
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+    }
+
+    __m256d gather(const std::vector<double>& v, __m256i at, __m256d mask) const {
+        return _mm256_mask_i64gather_pd(_mm256_setzero_pd(), v.data(), at, mask, 8);
+    }
+
+    void areas4(const std::size_t* offsets, double* out) const {
+        Lanes lanes (offsets);
+        __m256d sum = _mm256_setzero_pd();
+        __m256d mask = lanes.active(0);
+        __m256d xa = gather(x_, lanes.begin, mask);
+        __m256d ya = gather(y_, lanes.begin, mask);
+        for (int i = 0; i < lanes.max_n; ++i) {
+            mask = lanes.active(i);
+            __m256i b = lanes.at(i+1);
+            __m256d xb = gather(x_, b, mask);
+            __m256d yb = gather(y_, b, mask);
+            __m256d term = fmsub(xa, yb, _mm256_mul_pd(xb, ya));
+            sum = _mm256_blendv_pd(sum, _mm256_add_pd(sum, term), mask);
+            xa = xb;
+            ya = yb;
+        }
+        __m256d abs = _mm256_andnot_pd(_mm256_set1_pd(-0.0), sum);
+        _mm256_storeu_pd(out, _mm256_div_pd(abs, _mm256_set1_pd(2)));
+    }
+
+    static __m256d dist4(__m256d xa, __m256d ya, __m256d xb, __m256d yb) {
+        __m256d dx = _mm256_sub_pd(xa, xb);
+        __m256d dy = _mm256_sub_pd(ya, yb);
+        return _mm256_sqrt_pd(fmadd(dx, dx, _mm256_mul_pd(dy, dy)));
+    }
+
+    void perimeters4(const std::size_t* offsets, double* out) const {
+        Lanes lanes (offsets);
+        __m256d sum = _mm256_setzero_pd();
+        __m256d x0 = gather(x_, lanes.begin, lanes.active(0));
+        __m256d y0 = gather(y_, lanes.begin, lanes.active(0));
+        __m256d xa = x0;
+        __m256d ya = y0;
+        for (int i = 1; i < lanes.max_n; ++i) {
+            __m256d mask = lanes.active(i);
+            __m256i b = _mm256_add_epi64(lanes.begin, _mm256_set1_epi64x(i));
+            __m256d xb = gather(x_, b, mask);
+            __m256d yb = gather(y_, b, mask);
+            sum = _mm256_blendv_pd(sum, _mm256_add_pd(sum, dist4(xa, ya, xb, yb)), mask);
+            xa = _mm256_blendv_pd(xa, xb, mask);
+            ya = _mm256_blendv_pd(ya, yb, mask);
+        }
+        // closing side, for polygons with at least two vertices
+        sum = _mm256_blendv_pd(sum, _mm256_add_pd(sum, dist4(x0, y0, xa, ya)), lanes.active(1));
+        _mm256_storeu_pd(out, sum);
+    }
+#else
+    void areas4(const std::size_t*, double*) const {}
+
+    void perimeters4(const std::size_t*, double*) const {}
+#endif
+};
+
+#endif
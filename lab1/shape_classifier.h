@@ -0,0 +1,169 @@
+#ifndef SHAPE_CLASSIFIER_H
+#define SHAPE_CLASSIFIER_H
+
+#include <vector>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <algorithm>
+
+#include "arithmetic.h"
+#include "validation.h"
+
+// Tells what a ring of raw coordinates (x0, y0, x1, y1, ... as the shape constructors take
+// them) is without constructing anything or throwing. The checks are the same functions
+// the constructors use, and area and perimeter are added up in the same order as
+// Polygon::area() and Polygon::perimeter(), so the answers agree with what the
+// constructors would build.
+
+enum class ShapeKind {
+    Invalid,
+    Polygon,
+    Triangle,
+    Trapezoid,
+    RegularPolygon,
+};
+
+inline const char* kind_name(ShapeKind kind) {
+    switch (kind) {
+    case ShapeKind::Polygon:
+        return "polygon";
+    case ShapeKind::Triangle:
+        return "triangle";
+    case ShapeKind::Trapezoid:
+        return "trapezoid";
+    case ShapeKind::RegularPolygon:
+        return "regular polygon";
+    default:
+        return "invalid";
+    }
+}
+
+// Metrics are only filled in for valid polygons.
+struct ShapeInfo {
+    ShapeKind kind = ShapeKind::Invalid;
+    int n_points = 0;
+    double area = 0;
+    double perimeter = 0;
+};
+
+namespace classifier_detail {
+
+struct CoordPoint {
+    const double* p;
+
+    double x() const {
+        return p[0];
+    }
+
+    double y() const {
+        return p[1];
+    }
+};
+
+// Coordinates seen as a closed ring, indexed like ClosedLine.
+struct CoordRing {
+    const double* coords;
+    int n;
+
+    int n_points() const {
+        return n;
+    }
+
+    CoordPoint operator[](int i) const {
+        return CoordPoint {coords + 2*(i < n ? i : i % n)};
+    }
+};
+
+inline double area(const CoordRing& ring) {
+    double sum = 0;
+    for (int i = 0; i < ring.n; ++i) {
+        CoordPoint a = ring[i];
+        CoordPoint b = ring[i+1];
+        sum += cross_product(a.x(), a.y(), b.x(), b.y());
+    }
+    return std::abs(sum)/2;
+}
+
+inline double dist(const CoordPoint& a, const CoordPoint& b) {
+    return std::sqrt(squared_norm(a.x() - b.x(), a.y() - b.y()));
+}
+
+inline double perimeter(const CoordRing& ring) {
+    double sum = 0;
+    for (int i = 0; i + 1 < ring.n; ++i) {
+        sum += dist(ring[i], ring[i+1]);
+    }
+    return sum + dist(ring[0], ring[ring.n-1]);
+}
+
+}
+
+// The most specific kind the ring would pass as: a regular polygon before a triangle (an
+// equilateral triangle is both), then triangle or trapezoid, then any convex polygon.
+inline ShapeInfo classify(const double* coords, std::size_t n_coords, double epsilon = default_epsilon) {
+    using namespace classifier_detail;
+    ShapeInfo info;
+    if (n_coords%2) {
+        return info;
+    }
+    CoordRing ring {coords, int(n_coords/2)};
+    info.n_points = ring.n;
+    if (!is_convex_polygon(ring, epsilon)) {
+        return info;
+    }
+    info.area = area(ring);
+    info.perimeter = perimeter(ring);
+    if (is_regular_polygon(ring, epsilon)) {
+        info.kind = ShapeKind::RegularPolygon;
+    } else if (ring.n == 3) {
+        info.kind = ShapeKind::Triangle;
+    } else if (is_trapezoid(ring, epsilon)) {
+        info.kind = ShapeKind::Trapezoid;
+    } else {
+        info.kind = ShapeKind::Polygon;
+    }
+    return info;
+}
+
+inline ShapeInfo classify(const std::vector<double>& coords, double epsilon = default_epsilon) {
+    return classify(coords.data(), coords.size(), epsilon);
+}
+
+// Classifies rings[i] into out[i] on up to `threads` threads, which take the rings in
+// chunks from a shared counter so that rings of different sizes balance out.
+inline void classify_all(const std::vector<std::vector<double>>& rings, ShapeInfo* out,
+                         double epsilon = default_epsilon,
+                         unsigned threads = std::thread::hardware_concurrency()) {
+    const std::size_t chunk = 256;
+    std::size_t n_chunks = (rings.size() + chunk - 1) / chunk;
+    threads = std::max<std::size_t>(1, std::min<std::size_t>(threads, n_chunks));
+    std::atomic<std::size_t> next (0);
+    auto worker = [&]() {
+        for (std::size_t c; (c = next++) < n_chunks;) {
+            std::size_t end = std::min(rings.size(), (c + 1)*chunk);
+            for (std::size_t i = c*chunk; i < end; ++i) {
+                out[i] = classify(rings[i], epsilon);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
+
+inline std::vector<ShapeInfo> classify_all(const std::vector<std::vector<double>>& rings,
+                                           double epsilon = default_epsilon,
+                                           unsigned threads = std::thread::hardware_concurrency()) {
+    std::vector<ShapeInfo> ans (rings.size());
+    classify_all(rings, ans.data(), epsilon, threads);
+    return ans;
+}
+
+#endif
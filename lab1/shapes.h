@@ -0,0 +1,251 @@
+#ifndef SHAPES_H
+#define SHAPES_H
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+
+#include "arithmetic.h"
+#include "validation.h"
+
+inline bool double_eq(double d1, double d2, double epsilon=default_epsilon) {
+    return std::abs(d1 - d2) < epsilon;
+}
+
+
+class Shape {
+    virtual double area() const = 0;
+};
+
+class Point: public Shape {
+public:
+    Point(double x, double y) : x_(x), y_(y) {}
+
+    Point(const Point&) = default;
+
+    Point& operator=(const Point&) = default;
+
+    double dist(const Point& other) const {
+        return std::sqrt(squared_norm(x_-other.x_, y_-other.y_));
+    }
+
+    double area() const override {
+        return 0;
+    }
+
+    double x() const {
+        return x_;
+    }
+
+    double y() const {
+        return y_;
+    }
+
+    friend bool operator==(const Point& p1, const Point& p2) {
+        return (p1.x() == p2.x()) && (p1.y() == p2.y());
+    }
+    friend bool operator!=(const Point& p1, const Point& p2) {
+        return !(p1 == p2);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Point& point) {
+        os << "(" << point.x() << ", " << point.y() << ")";
+        return os;
+    }
+
+protected:
+    double x_;
+    double y_;
+};
+
+class Line: public Shape {
+public:
+    explicit Line(std::vector<Point>  points) : points_(std::move(points)) {}
+
+    explicit Line(const std::vector<double>& coords) {
+        if (coords.size()%2) {
+            throw std::invalid_argument("odd number of coordinates");
+        }
+        for (std::size_t i = 0; i < coords.size() / 2; ++i) {
+            points_.push_back(Point(coords[i*2], coords[i*2+1])); // emplace? who?
+        }
+    }
+
+    double area() const override {
+        return 0;
+    }
+
+    Line(const Line&) = default;
+
+    Line& operator=(const Line&) = default;
+
+    virtual double length() const {
+        double sum = 0;
+        for (std::size_t i = 1; i < points_.size(); ++i) {
+            sum += points_[i-1].dist(points_[i]);
+        }
+        return sum;
+    }
+
+    int n_points() const {
+        return points_.size();
+    }
+
+    virtual unsigned n_segments() const {
+        return points_.size()-1;
+    }
+
+    virtual const Point& operator[](int i) const {
+        return points_[i];
+    }
+
+    virtual std::ostream& print(std::ostream& os) const {
+        os << "[";
+        bool fst = true;
+        for (const Point& p : points_) {
+            if (fst) {
+                fst = false;
+            }
+            else {
+                os << ", ";
+            }
+            os << p;
+        }
+        os << "]";
+        return os;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Line& line) {
+        line.print(os);
+        return os;
+    }
+
+protected:
+    std::vector<Point> points_;
+};
+
+class ClosedLine: public Line {
+public:
+    using Line::Line;
+
+    double length() const override {
+        if (points_.size() > 1) {
+            return Line::length() + points_[0].dist(points_[points_.size() - 1]);
+        } else {
+            return 0;
+        }
+    }
+
+    unsigned n_segments() const override {
+        return points_.size();
+    }
+
+    // Final, so that calls through a ClosedLine are not virtual; most indices are in range
+    // and skip the division.
+    const Point &operator[](int i) const final {
+        return points_[i < n_points() ? i : i % n_points()];
+    }
+
+    virtual std::ostream& print(std::ostream& os) const override {
+        os << "Closed(";
+        Line::print(os);
+        return os << ")";
+    }
+};
+class Polygon: public Shape {
+public:
+    explicit Polygon(const std::vector<Point>& points, double epsilon = default_epsilon) : Polygon(ClosedLine(points), epsilon) {}
+    explicit Polygon(ClosedLine  line, double epsilon = default_epsilon) : line_(std::move(line)) {
+        if (!is_valid_polygon(epsilon)) {
+            throw std::invalid_argument ("not a polygon");
+        }
+    }
+    explicit Polygon(const std::vector<double>& coords, double epsilon = default_epsilon) : Polygon(ClosedLine(coords), epsilon) {}
+
+    Polygon(const Polygon&) = default;
+
+    Polygon& operator=(const Polygon&) = default;
+
+    int n_points() const {
+        return line_.n_points();
+    }
+
+    const ClosedLine& line() const {
+        return line_;
+    }
+
+    double perimeter() const {
+        return line_.length();
+    }
+
+    double area() const override {
+        double sum = 0;
+        for (int i = 0; i < n_points(); ++i) {
+            sum += cross_product(line_[i].x(), line_[i].y(), line_[i+1].x(), line_[i+1].y());
+        }
+        return std::abs(sum)/2;
+    }
+
+protected:
+    ClosedLine line_;
+    bool is_valid_polygon(double epsilon = default_epsilon) const {
+        return is_convex_polygon(line_, epsilon);
+    }
+};
+
+class Triangle : public Polygon {
+public:
+    explicit Triangle(const ClosedLine& line, double epsilon = default_epsilon) : Polygon(line, epsilon) {
+        if (!is_valid_triangle()) {
+            throw std::invalid_argument("not a triangle");
+        }
+    }
+
+    explicit Triangle(const std::vector<Point>& points, double epsilon = default_epsilon) : Triangle(ClosedLine(points), epsilon) {}
+
+    explicit Triangle(const std::vector<double>& coords, double epsilon = default_epsilon) : Triangle(ClosedLine(coords), epsilon) {}
+
+protected:
+    bool is_valid_triangle() {
+        return n_points() == 3;
+    }
+};
+
+class Trapezoid : public Polygon {
+public:
+    explicit Trapezoid(const ClosedLine& line, double epsilon = default_epsilon) : Polygon(line, epsilon) {
+        if (!is_valid_trapezoid(epsilon)) {
+            throw std::invalid_argument("not a trapezoid");
+        }
+    }
+
+    explicit Trapezoid(const std::vector<Point>& points, double epsilon = default_epsilon) : Trapezoid(ClosedLine(points), epsilon) {}
+
+    explicit Trapezoid(const std::vector<double>& coords, double epsilon = default_epsilon) : Trapezoid(ClosedLine(coords), epsilon) {}
+
+protected:
+    bool is_valid_trapezoid(double epsilon) {
+        return is_trapezoid(line_, epsilon);
+    }
+};
+
+class RegularPolygon : public Polygon {
+public:
+    explicit RegularPolygon(const ClosedLine& line, double epsilon = default_epsilon) : Polygon(line, epsilon) {
+        if (!is_valid_regular_polygon(epsilon)) {
+            throw std::invalid_argument("not a regular polygon");
+        }
+    }
+
+    explicit RegularPolygon(const std::vector<Point>& points, double epsilon = default_epsilon) : RegularPolygon(ClosedLine(points), epsilon) {}
+
+    explicit RegularPolygon(const std::vector<double>& coords, double epsilon = default_epsilon) : RegularPolygon(ClosedLine(coords), epsilon) {}
+
+protected:
+    bool is_valid_regular_polygon(double epsilon) {
+        return is_regular_polygon(line_, epsilon);
+    }
+};
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef STATIC_SHAPES_H
+#define STATIC_SHAPES_H
+
+#include <vector>
+#include <cmath>
+#include <variant>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "shapes.h"
+#include "arithmetic.h"
+#include "validation.h"
+
+// The shapes of shapes.h without virtual functions, for loops over many shapes. Vertices
+// are plain pairs of doubles, the line classes share their code through a CRTP base and
+// a mixed collection is a vector of AnyShape, dispatched with std::visit; all of it can be
+// inlined. Results are the same as those of the polymorphic classes, which stay as they
+// are for code that needs runtime polymorphism; each class here converts from its
+// counterpart there.
+namespace static_shapes {
+
+struct Vertex {
+    double x_;
+    double y_;
+
+    double x() const {
+        return x_;
+    }
+
+    double y() const {
+        return y_;
+    }
+
+    double dist(const Vertex& other) const {
+        return std::sqrt(squared_norm(x_ - other.x_, y_ - other.y_));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Vertex& v) {
+        os << "(" << v.x_ << ", " << v.y_ << ")";
+        return os;
+    }
+};
+
+template<class Derived>
+class LineBase {
+public:
+    explicit LineBase(std::vector<Vertex> points) : points_(std::move(points)) {}
+
+    explicit LineBase(const std::vector<double>& coords) {
+        if (coords.size()%2) {
+            throw std::invalid_argument("odd number of coordinates");
+        }
+        points_.reserve(coords.size()/2);
+        for (std::size_t i = 0; i < coords.size(); i += 2) {
+            points_.push_back(Vertex {coords[i], coords[i+1]});
+        }
+    }
+
+    explicit LineBase(const ::Line& line) {
+        points_.reserve(line.n_points());
+        for (int i = 0; i < line.n_points(); ++i) {
+            points_.push_back(Vertex {line[i].x(), line[i].y()});
+        }
+    }
+
+    double area() const {
+        return 0;
+    }
+
+    int n_points() const {
+        return points_.size();
+    }
+
+    unsigned n_segments() const {
+        return derived().n_segments();
+    }
+
+    const Vertex& operator[](int i) const {
+        return derived()[i];
+    }
+
+    double length() const {
+        return derived().length();
+    }
+
+    const std::vector<Vertex>& points() const {
+        return points_;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Derived& line) {
+        return line.print(os);
+    }
+
+protected:
+    std::vector<Vertex> points_;
+
+    const Derived& derived() const {
+        return static_cast<const Derived&>(*this);
+    }
+
+    double open_length() const {
+        double sum = 0;
+        for (int i = 0; i + 1 < n_points(); ++i) {
+            sum += points_[i].dist(points_[i+1]);
+        }
+        return sum;
+    }
+
+    std::ostream& print_points(std::ostream& os) const {
+        os << "[";
+        for (int i = 0; i < n_points(); ++i) {
+            if (i) {
+                os << ", ";
+            }
+            os << points_[i];
+        }
+        os << "]";
+        return os;
+    }
+};
+
+class Line : public LineBase<Line> {
+public:
+    using LineBase::LineBase;
+
+    unsigned n_segments() const {
+        return points_.size()-1;
+    }
+
+    const Vertex& operator[](int i) const {
+        return points_[i];
+    }
+
+    double length() const {
+        return open_length();
+    }
+
+    std::ostream& print(std::ostream& os) const {
+        return print_points(os);
+    }
+};
+
+class ClosedLine : public LineBase<ClosedLine> {
+public:
+    using LineBase::LineBase;
+
+    unsigned n_segments() const {
+        return points_.size();
+    }
+
+    // Vertex i for i in [0, 2*n_points()): one lap past the end wraps around without a
+    // division, which covers the closing side of every walk over the ring.
+    const Vertex& operator[](int i) const {
+        return points_[i < n_points() ? i : i - n_points()];
+    }
+
+    double length() const {
+        if (points_.size() > 1) {
+            return open_length() + points_[0].dist(points_[points_.size() - 1]);
+        } else {
+            return 0;
+        }
+    }
+
+    std::ostream& print(std::ostream& os) const {
+        os << "Closed(";
+        print_points(os);
+        os << ")";
+        return os;
+    }
+};
+
+class Polygon {
+public:
+    explicit Polygon(const std::vector<Vertex>& points, double epsilon = default_epsilon) : Polygon(ClosedLine(points), epsilon) {}
+    explicit Polygon(ClosedLine line, double epsilon = default_epsilon) : line_(std::move(line)) {
+        if (!is_convex_polygon(line_, epsilon)) {
+            throw std::invalid_argument ("not a polygon");
+        }
+    }
+    explicit Polygon(const std::vector<double>& coords, double epsilon = default_epsilon) : Polygon(ClosedLine(coords), epsilon) {}
+
+    // Already checked by the constructor of the polymorphic polygon.
+    explicit Polygon(const ::Polygon& polygon) : line_(polygon.line()) {}
+
+    int n_points() const {
+        return line_.n_points();
+    }
+
+    const ClosedLine& line() const {
+        return line_;
+    }
+
+    double perimeter() const {
+        return line_.length();
+    }
+
+    // Same terms in the same order as ::Polygon::area(), the last one closing the ring.
+    double area() const {
+        const std::vector<Vertex>& p = line_.points();
+        int n = p.size();
+        double sum = 0;
+        for (int i = 0; i + 1 < n; ++i) {
+            sum += cross_product(p[i].x(), p[i].y(), p[i+1].x(), p[i+1].y());
+        }
+        if (n) {
+            sum += cross_product(p[n-1].x(), p[n-1].y(), p[0].x(), p[0].y());
+        }
+        return std::abs(sum)/2;
+    }
+
+protected:
+    ClosedLine line_;
+};
+
+class Triangle : public Polygon {
+public:
+    explicit Triangle(const ClosedLine& line, double epsilon = default_epsilon) : Polygon(line, epsilon) {
+        if (n_points() != 3) {
+            throw std::invalid_argument("not a triangle");
+        }
+    }
+
+    explicit Triangle(const std::vector<Vertex>& points, double epsilon = default_epsilon) : Triangle(ClosedLine(points), epsilon) {}
+
+    explicit Triangle(const std::vector<double>& coords, double epsilon = default_epsilon) : Triangle(ClosedLine(coords), epsilon) {}
+
+    explicit Triangle(const ::Triangle& triangle) : Polygon(triangle) {}
+};
+
+class Trapezoid : public Polygon {
+public:
+    explicit Trapezoid(const ClosedLine& line, double epsilon = default_epsilon) : Polygon(line, epsilon) {
+        if (!is_trapezoid(line_, epsilon)) {
+            throw std::invalid_argument("not a trapezoid");
+        }
+    }
+
+    explicit Trapezoid(const std::vector<Vertex>& points, double epsilon = default_epsilon) : Trapezoid(ClosedLine(points), epsilon) {}
+
+    explicit Trapezoid(const std::vector<double>& coords, double epsilon = default_epsilon) : Trapezoid(ClosedLine(coords), epsilon) {}
+
+    explicit Trapezoid(const ::Trapezoid& trapezoid) : Polygon(trapezoid) {}
+};
+
+class RegularPolygon : public Polygon {
+public:
+    explicit RegularPolygon(const ClosedLine& line, double epsilon = default_epsilon) : Polygon(line, epsilon) {
+        if (!is_regular_polygon(line_, epsilon)) {
+            throw std::invalid_argument("not a regular polygon");
+        }
+    }
+
+    explicit RegularPolygon(const std::vector<Vertex>& points, double epsilon = default_epsilon) : RegularPolygon(ClosedLine(points), epsilon) {}
+
+    explicit RegularPolygon(const std::vector<double>& coords, double epsilon = default_epsilon) : RegularPolygon(ClosedLine(coords), epsilon) {}
+
+    explicit RegularPolygon(const ::RegularPolygon& polygon) : Polygon(polygon) {}
+};
+
+using AnyShape = std::variant<Line, ClosedLine, Polygon, Triangle, Trapezoid, RegularPolygon>;
+
+inline double area(const AnyShape& shape) {
+    return std::visit([](const auto& s) {
+        return s.area();
+    }, shape);
+}
+
+// Length of a line, perimeter of a polygon.
+inline double length(const AnyShape& shape) {
+    return std::visit([](const auto& s) {
+        if constexpr (std::is_base_of_v<Polygon, std::decay_t<decltype(s)>>) {
+            return s.perimeter();
+        } else {
+            return s.length();
+        }
+    }, shape);
+}
+
+inline double total_area(const std::vector<AnyShape>& shapes) {
+    double sum = 0;
+    for (const AnyShape& shape : shapes) {
+        sum += area(shape);
+    }
+    return sum;
+}
+
+inline double total_length(const std::vector<AnyShape>& shapes) {
+    double sum = 0;
+    for (const AnyShape& shape : shapes) {
+        sum += length(shape);
+    }
+    return sum;
+}
+
+}
+
+#endif
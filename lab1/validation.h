@@ -0,0 +1,197 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+const double default_epsilon = 0.005;
+
+// Checks on closed rings with only products and square roots per vertex. A ring is anything
+// with n_points() and operator[](i) returning a point with x() and y(), e.g. ClosedLine.
+// Angles are measured between consecutive edges, the edge into vertex i being
+// ring[i] - ring[i-1], the same walk the atan2 version of these checks used.
+
+namespace ring_detail {
+
+struct Vec {
+    double x;
+    double y;
+};
+
+// Edge into vertex i, for i in [0, n].
+template<class Ring>
+Vec edge(const Ring& ring, int i) {
+    int n = ring.n_points();
+    const auto& from = ring[i == 0 ? n - 1 : i - 1];
+    const auto& to = ring[i == n ? 0 : i];
+    return Vec {to.x() - from.x(), to.y() - from.y()};
+}
+
+// Edge from (x, y) to p, after which (x, y) is p. Starting from the last vertex and
+// stepping through vertices 0, 1, ... gives the edges into them reading each vertex once.
+template<class Point>
+Vec step(double& x, double& y, const Point& p) {
+    Vec v {p.x() - x, p.y() - y};
+    x = p.x();
+    y = p.y();
+    return v;
+}
+
+inline double cross(const Vec& a, const Vec& b) {
+    return a.x*b.y - a.y*b.x;
+}
+
+inline double dot(const Vec& a, const Vec& b) {
+    return a.x*b.x + a.y*b.y;
+}
+
+// Directions in [0, pi) have half 0, in [pi, 2pi) half 1.
+inline int half(const Vec& v) {
+    return v.y < 0 || (v.y == 0 && v.x < 0);
+}
+
+// Direction of a is before direction of b, counting from the positive x axis.
+inline bool before(const Vec& a, const Vec& b) {
+    return half(a) != half(b) ? half(a) < half(b) : cross(a, b) > 0;
+}
+
+inline double length(const Vec& v) {
+    return std::sqrt(v.x*v.x + v.y*v.y);
+}
+
+}
+
+// Turns whose sine is within this many ulps of zero are too close to call from the
+// coordinates alone and count as straight (or, going back along the edge, as reversed).
+const double straight_turn_ulps = 64;
+
+// Convex polygon walked once around: at least three vertices, no zero-length edge, every
+// turn in the same direction and none of them straight, and the first turn at least
+// epsilon radians (a turn back along the same edge counts as a left turn of pi). One full
+// winding is checked by counting how many times the edge direction passes the positive
+// x axis. Angles are compared through their sines and cosines, so no vertex needs more
+// than products.
+template<class Ring>
+bool is_convex_polygon(const Ring& ring, double epsilon = default_epsilon) {
+    using namespace ring_detail;
+    int n = ring.n_points();
+    if (n < 3) {
+        return false;
+    }
+    double straight2 = straight_turn_ulps*std::numeric_limits<double>::epsilon();
+    straight2 *= straight2;
+    double sin_epsilon = std::sin(std::min(epsilon, M_PI));
+    double sin2_epsilon = sin_epsilon*sin_epsilon;
+    Vec old_edge = edge(ring, n - 1);
+    double x = ring[n - 1].x();
+    double y = ring[n - 1].y();
+    int orient = 0;
+    int windings = 0;
+    for (int i = 0; i < n; ++i) {
+        Vec new_edge = step(x, y, ring[i]);
+        if (new_edge.x == 0 && new_edge.y == 0) {
+            return false;
+        }
+        double c = cross(old_edge, new_edge);
+        double d = dot(old_edge, new_edge);
+        // |a|^2 |b|^2, so that c^2 / lengths2 is the squared sine of the turn
+        double lengths2 = dot(old_edge, old_edge)*dot(new_edge, new_edge);
+        int turn;
+        if (c*c <= straight2*lengths2) {
+            turn = d < 0 ? 1 : 0;
+        } else {
+            turn = c > 0 ? 1 : -1;
+        }
+        if (turn == 0) {
+            return false;
+        }
+        if (i == 0) {
+            // |turn| < epsilon: below a right angle the sine grows with the angle, above
+            // it shrinks
+            bool small = epsilon >= M_PI || (epsilon <= M_PI/2
+                    ? d > 0 && c*c < sin2_epsilon*lengths2
+                    : d > 0 || c*c > sin2_epsilon*lengths2);
+            if (small) {
+                return false;
+            }
+            orient = turn;
+        } else if (turn != orient) {
+            return false;
+        }
+        if (orient > 0 ? before(new_edge, old_edge) : before(old_edge, new_edge)) {
+            windings++;
+        }
+        old_edge = new_edge;
+    }
+    return windings == 1;
+}
+
+// Quadrilateral with exactly one pair of opposite sides parallel, parallel meaning the
+// cross product of the two sides is within epsilon of zero.
+template<class Ring>
+bool is_trapezoid(const Ring& ring, double epsilon = default_epsilon) {
+    using namespace ring_detail;
+    if (ring.n_points() != 4) {
+        return false;
+    }
+    int n_parallel = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (std::abs(cross(edge(ring, i + 1), edge(ring, i + 3))) < epsilon) {
+            n_parallel++;
+        }
+    }
+    return n_parallel == 1;
+}
+
+// Every side within epsilon of perimeter / n and every interior angle within epsilon
+// radians of (n-2)pi/n. The angle bounds are turned into bounds on the cosine once, so
+// each vertex costs a dot product against the product of the side lengths. The angles
+// need no totals and are checked in the same walk that sums the perimeter, so most
+// rings are rejected at their first vertices; the sides are then only compared through
+// the shortest and the longest, as rounding keeps their order.
+template<class Ring>
+bool is_regular_polygon(const Ring& ring, double epsilon = default_epsilon) {
+    using namespace ring_detail;
+    int n = ring.n_points();
+    if (n < 3) {
+        return false;
+    }
+    double good_angle = ((n - 2) * M_PI) / n;
+    bool any_low = good_angle + epsilon > M_PI;
+    double cos_low = std::cos(std::min(good_angle + epsilon, M_PI));
+    double cos_high = std::cos(std::max(good_angle - epsilon, 0.0));
+
+    Vec old_edge = edge(ring, n - 1);
+    double old_length = length(old_edge);
+    double x = ring[n - 1].x();
+    double y = ring[n - 1].y();
+    // summed in the order of ClosedLine::length(), whose closing side is the first here
+    double first_length = 0;
+    double perimeter = 0;
+    double shortest = 0;
+    double longest = 0;
+    for (int i = 0; i < n; ++i) {
+        Vec new_edge = step(x, y, ring[i]);
+        double new_length = length(new_edge);
+        // cosine of the interior angle times both side lengths
+        double scaled_cos = -dot(old_edge, new_edge);
+        double scale = old_length*new_length;
+        if (!(scaled_cos < cos_high*scale) || !(any_low || scaled_cos > cos_low*scale)) {
+            return false;
+        }
+        if (i == 0) {
+            first_length = shortest = longest = new_length;
+        } else {
+            perimeter += new_length;
+            shortest = std::min(shortest, new_length);
+            longest = std::max(longest, new_length);
+        }
+        old_edge = new_edge;
+        old_length = new_length;
+    }
+    double good_length = (perimeter + first_length) / n;
+    return std::abs(shortest - good_length) < epsilon && std::abs(longest - good_length) < epsilon;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "instrumentation.h"
+
+// Replacement operator new that feeds AllocationCounter. These are definitions, so include
+// this header in exactly one translation unit of an executable; without it the profiler
+// reports zero allocations.
+void* operator new(std::size_t size) {
+    if (AllocationCounter::enabled.load(std::memory_order_relaxed)) {
+        AllocationCounter::count.fetch_add(1, std::memory_order_relaxed);
+        AllocationCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC sees the new/free pairing once these are inlined into the same translation unit
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "memory_usage.h"
+#include "route_metrics.h"
+#include "scan.h"
+#include "station_reader.h"
+#include "tasks.h"
+
+// Times every phase of the pipeline on one or more feeds, e.g. the outputs of
+//     gen_dataset data10.xml 10; gen_dataset data100.xml 100; ...
+//     bench_scaling data.xml data10.xml data100.xml
+// Each task is measured as a full scan with only that task attached, minus the bare scan,
+// so the columns stay comparable as the feed grows. ns/station should stay flat across
+// scales; a growing value points at a super-linear phase. Peak RSS is process-wide, so
+// list the feeds from smallest to largest or run one per invocation.
+
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+class Counter : public Aggregator {
+public:
+    std::size_t stations = 0;
+
+    void consume(const Station&) override {
+        ++stations;
+    }
+};
+
+const int repeats = 3;
+
+// one scan of the file with `aggregator` attached, then `finish`; returns seconds
+template<class F>
+double timed_pass(const std::string& path, Dictionary& dictionary, Aggregator& aggregator, F finish) {
+    Stopwatch watch;
+    Scanner scanner (dictionary);
+    scanner.add(aggregator);
+    ShardedStationReader reader (path);
+    if (!reader) {
+        throw std::runtime_error("error loading " + path);
+    }
+    reader.run(scanner);
+    finish();
+    return watch.seconds();
+}
+
+// best of `repeats` runs of `pass`; the first run also warms the page cache
+template<class Pass>
+double best_pass(Pass pass) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < repeats; ++r) {
+        best = std::min(best, pass());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "usage: bench_scaling <feed.xml>..." << std::endl;
+        return 1;
+    }
+    std::cout << std::left << std::setw(24) << "feed" << std::right
+              << std::setw(10) << "stations" << std::setw(10) << "parse,s" << std::setw(10) << "task1,s"
+              << std::setw(10) << "task2,s" << std::setw(10) << "task3,s" << std::setw(14) << "stations/s"
+              << std::setw(12) << "ns/station" << std::setw(12) << "peak RSS,MB" << std::endl;
+    std::cout << std::fixed;
+    for (int i = 1; i < argc; ++i) {
+        std::string path = argv[i];
+        try {
+            std::size_t stations = 0, results = 0;
+            double parse = best_pass([&] {
+                Dictionary dictionary;
+                Counter counter;
+                double seconds = timed_pass(path, dictionary, counter, [] {});
+                stations = counter.stations;
+                return seconds;
+            });
+            double task1 = std::max(0.0, best_pass([&] {
+                Dictionary dictionary;
+                RouteCounts route_counts (dictionary);
+                return timed_pass(path, dictionary, route_counts, [&] {
+                    results += route_counts.result().size();
+                });
+            }) - parse);
+            double task2 = std::max(0.0, best_pass([&] {
+                Dictionary dictionary;
+                RoutePoints route_points (dictionary);
+                return timed_pass(path, dictionary, route_points, [&] {
+                    RouteMetrics route_metrics (route_points);
+                    results += route_metrics.longest_routes().size();
+                });
+            }) - parse);
+            double task3 = std::max(0.0, best_pass([&] {
+                Dictionary dictionary;
+                StreetCounts street_counts (dictionary);
+                return timed_pass(path, dictionary, street_counts, [&] {
+                    results += street_counts.result().second;
+                });
+            }) - parse);
+            double total = parse + task1 + task2 + task3;
+            std::cout << std::left << std::setw(24) << path << std::right
+                      << std::setw(10) << stations
+                      << std::setprecision(3) << std::setw(10) << parse << std::setw(10) << task1
+                      << std::setw(10) << task2 << std::setw(10) << task3
+                      << std::setprecision(0) << std::setw(14) << stations / total
+                      << std::setw(12) << total * 1e9 / std::max<std::size_t>(1, stations)
+                      << std::setprecision(1) << std::setw(12) << peak_rss_bytes() / 1048576.0
+                      << std::endl;
+            if (results == 0) {
+                std::cout << path << ": no results" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cout << path << ": " << e.what() << std::endl;
+        }
+    }
+}
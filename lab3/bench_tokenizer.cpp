@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <regex>
+
+#include "util.h"
+#include "tokenizer.h"
+#include "xml_record.h"
+#include "mapped_file.h"
+
+template<class F>
+double time_ms(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "data.xml";
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    MappedFile file (path);
+    if (!file) {
+        std::cout << "error loading file" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> routes, coords, locations;
+    for_each_record(file.data(), file.data() + file.size(), [&](char* body, char* body_end) {
+        for_each_field(body, body_end, [&](std::string_view name, char* value_begin, char* value_end) {
+            if (name == "routes") {
+                routes.emplace_back(xml_unescape(value_begin, value_end));
+            } else if (name == "coordinates") {
+                coords.emplace_back(xml_unescape(value_begin, value_end));
+            } else if (name == "location") {
+                locations.emplace_back(xml_unescape(value_begin, value_end));
+            }
+        });
+    });
+
+    static const std::regex comma_rgx (",");
+    static const std::regex dot_rgx ("\\.");
+    static const std::regex location_rgx ("\\s*,\\s*");
+    std::size_t regex_check = 0;
+    std::size_t tokenizer_check = 0;
+    double sink = 0;
+
+    double regex_ms = time_ms([&]() {
+        for (int r = 0; r < repeats; ++r) {
+            for (const std::string& s : routes) {
+                std::vector<std::string> cut = split(s, dot_rgx, false);
+                regex_check += cut.empty() ? 0 : split(cut[0], comma_rgx, false).size();
+            }
+            for (const std::string& s : coords) {
+                std::vector<std::string> parts = split(s, comma_rgx, false);
+                sink += std::stod(parts[0]) + std::stod(parts[1]);
+            }
+            for (const std::string& s : locations) {
+                regex_check += split(s, location_rgx, false).size();
+            }
+        }
+    });
+
+    double tokenizer_ms = time_ms([&]() {
+        for (int r = 0; r < repeats; ++r) {
+            for (const std::string& s : routes) {
+                for_each_token(first_token(s, '.'), ',', [&](std::string_view) {
+                    ++tokenizer_check;
+                });
+            }
+            for (const std::string& s : coords) {
+                auto [lat, lon] = parse_coords(s);
+                sink -= lat + lon;
+            }
+            for (const std::string& s : locations) {
+                for_each_list_item(s, [&](std::string_view) {
+                    ++tokenizer_check;
+                });
+            }
+        }
+    });
+
+    std::size_t fields = (routes.size() + coords.size() + locations.size()) * repeats;
+    std::cout << "fields: " << fields << " (tokens " << regex_check << " / " << tokenizer_check << ", drift " << sink << ")" << std::endl;
+    std::cout << "regex split: " << regex_ms << " ms" << std::endl;
+    std::cout << "tokenizer:   " << tokenizer_ms << " ms" << std::endl;
+    std::cout << "speedup:     " << regex_ms / tokenizer_ms << "x" << std::endl;
+}
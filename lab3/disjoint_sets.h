@@ -0,0 +1,41 @@
+#ifndef DISJOINT_SETS_H
+#define DISJOINT_SETS_H
+
+#include <vector>
+#include <numeric>
+#include <utility>
+
+class DisjointSets {
+public:
+    explicit DisjointSets(int n) : parent_(n), size_(n, 1) {
+        std::iota(parent_.begin(), parent_.end(), 0);
+    }
+
+    int find(int x) {
+        while (parent_[x] != x) {
+            parent_[x] = parent_[parent_[x]];
+            x = parent_[x];
+        }
+        return x;
+    }
+
+    bool unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return false;
+        }
+        if (size_[a] < size_[b]) {
+            std::swap(a, b);
+        }
+        parent_[b] = a;
+        size_[a] += size_[b];
+        return true;
+    }
+
+private:
+    std::vector<int> parent_;
+    std::vector<int> size_;
+};
+
+#endif
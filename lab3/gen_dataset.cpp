@@ -0,0 +1,151 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <unordered_map>
+
+#include "scan.h"
+#include "station_reader.h"
+
+// Writes a synthetic feed that looks like data.xml at a multiple of its size:
+//     gen_dataset <out.xml> <scale> [routes_per_stop] [stops_per_route] [seed]
+// Stop types, locations and the spread of positions are sampled from data.xml. Each route
+// is a random walk through the city; every stop lists its own route plus routes of the
+// same type, so the averages of routes per stop and stops per route match the arguments
+// (measured from data.xml by default).
+
+struct Sample {
+    std::string type;
+    std::string location;
+    std::pair<double, double> coords;
+};
+
+class Sampler : public Aggregator {
+public:
+    std::vector<Sample> samples;
+    std::size_t route_refs = 0;
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> routes;
+
+    void consume(const Station& station) override {
+        Sample sample {std::string(station.type), std::string(), station.coords};
+        for (std::string_view street : station.streets) {
+            if (!sample.location.empty()) {
+                sample.location += ", ";
+            }
+            sample.location += street;
+        }
+        samples.push_back(std::move(sample));
+        route_refs += station.routes.size();
+        for (std::string_view route : station.routes) {
+            routes[std::string(station.type)][std::string(route)]++;
+        }
+    }
+};
+
+std::string xml_escape(std::string_view s) {
+    std::string ans;
+    for (char c : s) {
+        switch (c) {
+            case '<':
+                ans += "&lt;";
+                break;
+            case '>':
+                ans += "&gt;";
+                break;
+            case '&':
+                ans += "&amp;";
+                break;
+            default:
+                ans += c;
+        }
+    }
+    return ans;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "usage: gen_dataset <out.xml> <scale> [routes_per_stop] [stops_per_route] [seed]" << std::endl;
+        return 1;
+    }
+    std::string out_path = argv[1];
+    double scale = std::stod(argv[2]);
+
+    MappedStationReader reader ("data.xml");
+    if (!reader) {
+        std::cout << "error loading file" << std::endl;
+        return 1;
+    }
+    Sampler sampler;
+    reader.run(sampler);
+    if (sampler.samples.empty()) {
+        std::cout << "no stations in data.xml" << std::endl;
+        return 1;
+    }
+    std::size_t n_routes = 0;
+    for (const auto& [type, routes] : sampler.routes) {
+        n_routes += routes.size();
+    }
+    double routes_per_stop = argc > 3 ? std::stod(argv[3]) : double(sampler.route_refs) / sampler.samples.size();
+    double stops_per_route = argc > 4 ? std::stod(argv[4]) : double(sampler.route_refs) / n_routes;
+    std::mt19937_64 rng (argc > 5 ? std::stoull(argv[5]) : 2021);
+
+    std::size_t n_stations = std::llround(sampler.samples.size() * scale);
+    std::size_t total_routes = std::max<std::size_t>(1, std::llround(n_stations * routes_per_stop / stops_per_route));
+    std::cerr << n_stations << " stations, " << total_routes << " routes, "
+              << routes_per_stop << " routes/stop, " << stops_per_route << " stops/route" << std::endl;
+
+    // every route starts at a sampled stop and keeps its vehicle type
+    std::vector<std::size_t> route_origin (total_routes);
+    std::unordered_map<std::string, std::vector<std::size_t>> routes_of_type;
+    std::uniform_int_distribution<std::size_t> pick_sample (0, sampler.samples.size() - 1);
+    for (std::size_t r = 0; r < total_routes; ++r) {
+        route_origin[r] = pick_sample(rng);
+        routes_of_type[sampler.samples[route_origin[r]].type].push_back(r);
+    }
+
+    std::ofstream out (out_path, std::ios::binary);
+    if (!out) {
+        std::cout << "error writing " << out_path << std::endl;
+        return 1;
+    }
+    out << "<?xml version='1.0' encoding='utf-8'?>\n<dataset>\n";
+
+    std::normal_distribution<double> step (0, 0.004);
+    std::poisson_distribution<int> extra_routes (std::max(0.0, routes_per_stop - 1));
+    std::uniform_int_distribution<std::size_t> pick_route (0, total_routes - 1);
+    std::vector<std::pair<double, double>> position (total_routes);
+    for (std::size_t r = 0; r < total_routes; ++r) {
+        position[r] = sampler.samples[route_origin[r]].coords;
+    }
+    for (std::size_t i = 0; i < n_stations; ++i) {
+        std::size_t own = pick_route(rng);
+        const Sample& origin = sampler.samples[route_origin[own]];
+        const Sample& look = sampler.samples[pick_sample(rng)];
+        std::string name = xml_escape(look.location.substr(0, look.location.find(',')));
+        position[own].first += step(rng);
+        position[own].second += step(rng)*2;
+        const std::vector<std::size_t>& same_type = routes_of_type[origin.type];
+        std::string routes = std::to_string(own + 1);
+        int extra = extra_routes(rng);
+        for (int e = 0; e < extra; ++e) {
+            std::uniform_int_distribution<std::size_t> pick_same (0, same_type.size() - 1);
+            routes += "," + std::to_string(same_type[pick_same(rng)] + 1);
+        }
+        char coords[64];
+        std::snprintf(coords, sizeof(coords), "%.6f,%.6f", position[own].first, position[own].second);
+        out << "  <transport_station>\n"
+            << "    <number>" << i + 1 << "</number>\n"
+            << "    <type_of_vehicle>" << xml_escape(origin.type) << "</type_of_vehicle>\n"
+            << "    <object_type>Остановка</object_type>\n"
+            << "    <name_stopping>" << name << "</name_stopping>\n"
+            << "    <the_official_name>" << name << "</the_official_name>\n"
+            << "    <location>" << xml_escape(look.location) << "</location>\n"
+            << "    <routes>" << routes << "</routes>\n"
+            << "    <coordinates>" << coords << "</coordinates>\n"
+            << "  </transport_station>\n";
+    }
+    out << "</dataset>\n";
+    return out ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+
+inline double distance(const std::pair<double, double>& p1, const std::pair<double, double>& p2) {
+    static const double R = 6371000;
+    auto [lat1, lon1] = p1;
+    auto [lat2, lon2] = p2;
+    lat1 = lat1*M_PI/180;
+    lon1 = lon1*M_PI/180;
+    lat2 = lat2*M_PI/180;
+    lon2 = lon2*M_PI/180;
+    return R*2*std::asin(std::sqrt((1 - std::cos(lat1-lat2))/2 + std::cos(lat1)*std::cos(lat2)*(1 - std::cos(lon1-lon2))/2));
+}
+
+// Point on the unit sphere. Chord length between unit vectors grows monotonically
+// with the great-circle distance, so nearest-neighbour order is the same.
+inline std::array<double, 3> unit_vector(const std::pair<double, double>& p) {
+    double lat = p.first*M_PI/180;
+    double lon = p.second*M_PI/180;
+    return {std::cos(lat)*std::cos(lon), std::cos(lat)*std::sin(lon), std::sin(lat)};
+}
+
+inline double mst_weight(const std::vector<std::pair<double, double>>& points) {
+    int n = points.size();
+    std::vector<bool> in_set (n, false);
+    std::vector<double> keys (n, 1000000);
+    keys[0] = 0;
+    double ans = 0;
+    for (int i = 0; i < n; ++i) {
+        double mn = 1000000;
+        int u = 0;
+        for (int j = 0; j < n; ++j) {
+            if (keys[j] < mn && !in_set[j]) {
+                mn = keys[j];
+                u = j;
+            }
+        }
+        in_set[u] = true;
+        ans += keys[u];
+        for (int j = 0; j < n; ++j) {
+            if (!in_set[j]) {
+                double d = distance(points[u], points[j]);
+                if (d < keys[j]) {
+                    keys[j] = d;
+                }
+            }
+        }
+    }
+    return ans;
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef GEO_MST_H
+#define GEO_MST_H
+
+#include <vector>
+#include <limits>
+
+#include "geo.h"
+#include "station_coords.h"
+#include "kdtree.h"
+#include "disjoint_sets.h"
+
+// Exact geographic MST weight by Boruvka over a k-d tree of unit vectors: every round
+// each component takes its nearest outside point, found without scanning all pairs.
+// Ties are broken by (distance, lower index, higher index), so the edge order is total.
+inline double boruvka_mst_weight(const std::vector<std::pair<double, double>>& points) {
+    int n = points.size();
+    std::vector<Vec3> units;
+    units.reserve(n);
+    for (const std::pair<double, double>& p : points) {
+        units.push_back(unit_vector(p));
+    }
+    KdTree tree (units);
+    DisjointSets sets (n);
+    std::vector<int> component (n);
+    std::vector<double> best_d2 (n);
+    std::vector<std::pair<int, int>> best_edge (n);
+    double ans = 0;
+    for (int components = n; components > 1;) {
+        for (int i = 0; i < n; ++i) {
+            component[i] = sets.find(i);
+        }
+        std::vector<int> node_component = tree.uniform_labels(component);
+        std::fill(best_d2.begin(), best_d2.end(), std::numeric_limits<double>::infinity());
+        std::fill(best_edge.begin(), best_edge.end(), std::make_pair(-1, -1));
+        for (int i = 0; i < n; ++i) {
+            int c = component[i];
+            int j = -1;
+            double d2 = best_d2[c];
+            tree.nearest(units[i], [&](int node) {
+                return node_component[node] == c;
+            }, [&](int index) {
+                return component[index] != c;
+            }, j, d2);
+            if (j < 0) {
+                continue;
+            }
+            std::pair<int, int> edge = std::minmax(i, j);
+            if (d2 < best_d2[c] || (d2 == best_d2[c] && edge < best_edge[c])) {
+                best_d2[c] = d2;
+                best_edge[c] = edge;
+            }
+        }
+        for (int c = 0; c < n; ++c) {
+            auto [i, j] = best_edge[c];
+            if (i >= 0 && sets.unite(i, j)) {
+                ans += chord2_to_meters(best_d2[c]);
+                --components;
+            }
+        }
+    }
+    return ans;
+}
+
+// Dense Prim over the SoA kernels wins on small routes; larger ones go through Boruvka.
+inline double geo_mst_weight(const std::vector<std::pair<double, double>>& points) {
+    static const std::size_t dense_limit = 4096;
+    if (points.size() <= dense_limit) {
+        return prim_mst_weight(StationCoords(points));
+    }
+    return boruvka_mst_weight(points);
+}
+
+#endif
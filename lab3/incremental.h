@@ -0,0 +1,394 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+#include "scan.h"
+#include "xml_record.h"
+#include "mapped_file.h"
+#include "street_normalizer.h"
+#include "geo_mst.h"
+#include "parallel.h"
+#include "ranking.h"
+
+// task1/task2/task3 state that can be updated station by station. Every station gets a
+// sequence number (feed order); changed stations keep theirs, added ones go to the end.
+// All tables depend only on the current stations and their order, so applying a delta
+// gives exactly what a full rebuild of the new feed gives. Ties are broken by the first
+// occurrence in feed order, which is also what the full scan does.
+//
+// Stations come with ids from the shared dictionary, as a Scanner hands them out, and their
+// lines are taken as they are rather than rebuilt from type and routes: a station replayed
+// by StopClusters can serve lines of several types.
+class IncrementalTasks : public Aggregator {
+public:
+    explicit IncrementalTasks(Dictionary& dictionary, unsigned threads = default_threads(), StreetNormalizer normalizer = StreetNormalizer())
+            : dictionary_(dictionary)
+            , threads_(threads)
+            , normalizer_(std::move(normalizer)) {}
+
+    void consume(const Station& station) override {
+        upsert(station);
+    }
+
+    // Adds a station, or replaces the one with the same number in place.
+    void upsert(const Station& station) {
+        int seq;
+        auto it = slots_.find(station.number);
+        if (it != slots_.end()) {
+            seq = it->second.seq;
+            retract(it->second);
+        } else {
+            seq = next_seq_++;
+        }
+        Slot& slot = slots_[station.number];
+        slot.seq = seq;
+        slot.type = station.type_id;
+        slot.lines = station.lines;
+        slot.streets = station.street_ids;
+        slot.coords = station.coords;
+        apply(slot);
+    }
+
+    bool remove(int number) {
+        auto it = slots_.find(number);
+        if (it == slots_.end()) {
+            return false;
+        }
+        retract(it->second);
+        slots_.erase(it);
+        return true;
+    }
+
+    int size() const {
+        return slots_.size();
+    }
+
+    // Applies a delta file: <added> and <changed> hold full <transport_station> records,
+    // <removed> holds records of which only <number> is read.
+    bool apply_delta(const std::string& path) {
+        MappedFile file (path);
+        if (!file) {
+            return false;
+        }
+        char* begin = file.data();
+        char* end = begin + file.size();
+        for (std::string_view section : {"added", "changed", "removed"}) {
+            std::string open = "<" + std::string(section) + ">";
+            std::string close = "</" + std::string(section) + ">";
+            for (char* pos = begin; ;) {
+                char* section_begin = std::search(pos, end, open.begin(), open.end());
+                if (section_begin == end) {
+                    break;
+                }
+                section_begin += open.size();
+                char* section_end = std::search(section_begin, end, close.begin(), close.end());
+                Station station;
+                for_each_record(section_begin, section_end, [&](char* body, char* body_end) {
+                    if (section == "removed") {
+                        remove(decode_number(body, body_end));
+                    } else {
+                        decode_station(body, body_end, station);
+                        dictionary_.resolve(station);
+                        upsert(station);
+                    }
+                });
+                pos = section_end;
+            }
+        }
+        return true;
+    }
+
+    // Takes the MST weight of a line from elsewhere, e.g. a snapshot of the feed consumed so
+    // far, so that only lines touched afterwards are recomputed. It must be what
+    // geo_mst_weight gives over the line's current stops in feed order.
+    void seed_mst(int line, double weight) {
+        if (line >= 0 && line < int(lines_.size())) {
+            mst_[line] = weight;
+            dirty_[line] = false;
+        }
+    }
+
+    // Hands the current stations to an aggregator in feed order, e.g. to cluster the feed
+    // as it stands after the deltas.
+    void replay(Aggregator& aggregator) const {
+        std::vector<std::pair<int, int>> order;
+        order.reserve(slots_.size());
+        for (const auto& [number, slot] : slots_) {
+            order.emplace_back(slot.seq, number);
+        }
+        std::sort(order.begin(), order.end());
+        Station station;
+        for (auto [seq, number] : order) {
+            const Slot& slot = slots_.at(number);
+            station.number = number;
+            station.type_id = slot.type;
+            station.type = dictionary_.types.name(slot.type);
+            station.coords = slot.coords;
+            station.lines = slot.lines;
+            station.routes.clear();
+            for (int line : slot.lines) {
+                station.routes.push_back(route_name(line));
+            }
+            station.street_ids = slot.streets;
+            station.streets.clear();
+            for (int street : slot.streets) {
+                station.streets.push_back(dictionary_.streets.name(street));
+            }
+            aggregator.consume(station);
+        }
+    }
+
+    std::unordered_map<std::string_view, std::pair<std::string_view, int>> task1() const {
+        std::vector<int> best = champions([&](int line) {
+            return double(lines_[line].size());
+        });
+        std::unordered_map<std::string_view, std::pair<std::string_view, int>> ans;
+        for (int type = 0; type < int(best.size()); ++type) {
+            if (best[type] >= 0) {
+                ans[dictionary_.types.name(type)] = std::make_pair(route_name(best[type]), int(lines_[best[type]].size()));
+            }
+        }
+        return ans;
+    }
+
+    std::unordered_map<std::string_view, std::pair<std::string_view, double>> task2() {
+        update_mst();
+        std::vector<int> best = champions([&](int line) {
+            return mst_[line];
+        });
+        std::unordered_map<std::string_view, std::pair<std::string_view, double>> ans;
+        for (int type = 0; type < int(best.size()); ++type) {
+            if (best[type] >= 0) {
+                ans[dictionary_.types.name(type)] = std::make_pair(route_name(best[type]), mst_[best[type]]);
+            }
+        }
+        return ans;
+    }
+
+    std::pair<std::string_view, int> task3() const {
+        int champ = -1;
+        for (int street = 0; street < int(streets_.size()); ++street) {
+            if (!streets_[street].empty() && (champ < 0 || better(streets_[street].size(), *streets_[street].begin(),
+                                                                   streets_[champ].size(), *streets_[champ].begin()))) {
+                champ = street;
+            }
+        }
+        if (champ < 0) {
+            return std::make_pair(std::string_view(), 0);
+        }
+        return std::make_pair(names_.name(champ), int(streets_[champ].size()));
+    }
+
+    // The k best routes of a type by stop count or by length and the k busiest streets, best
+    // first, ranked and tie-broken as Rankings does on a full scan of the current stations.
+    std::vector<std::pair<std::string_view, int>> routes_by_stops(std::string_view type, int k) const {
+        std::vector<std::pair<std::string_view, int>> ans;
+        for (int line : top_k(lines_of_type(type), k, [&](int l1, int l2) {
+            return better(lines_[l1].size(), lines_[l1].front().at, lines_[l2].size(), lines_[l2].front().at);
+        })) {
+            ans.emplace_back(route_name(line), int(lines_[line].size()));
+        }
+        return ans;
+    }
+
+    std::vector<std::pair<std::string_view, double>> routes_by_length(std::string_view type, int k) {
+        update_mst();
+        std::vector<std::pair<std::string_view, double>> ans;
+        for (int line : top_k(lines_of_type(type), k, [&](int l1, int l2) {
+            return better(mst_[l1], lines_[l1].front().at, mst_[l2], lines_[l2].front().at);
+        })) {
+            ans.emplace_back(route_name(line), mst_[line]);
+        }
+        return ans;
+    }
+
+    std::vector<std::pair<std::string_view, int>> streets(int k) const {
+        std::vector<int> candidates;
+        for (int street = 0; street < int(streets_.size()); ++street) {
+            if (!streets_[street].empty()) {
+                candidates.push_back(street);
+            }
+        }
+        std::vector<std::pair<std::string_view, int>> ans;
+        for (int street : top_k(std::move(candidates), k, [&](int s1, int s2) {
+            return better(streets_[s1].size(), *streets_[s1].begin(), streets_[s2].size(), *streets_[s2].begin());
+        })) {
+            ans.emplace_back(names_.name(street), int(streets_[street].size()));
+        }
+        return ans;
+    }
+
+private:
+    // Position of one occurrence in feed order: (station seq, index within the station, sub-index).
+    using Occurrence = std::tuple<int, int, int>;
+
+    struct Slot {
+        int seq;
+        int type;
+        std::vector<int> lines;
+        std::vector<int> streets;
+        std::pair<double, double> coords;
+    };
+
+    struct Stop {
+        Occurrence at;
+        std::pair<double, double> coords;
+
+        friend bool operator<(const Stop& s1, const Stop& s2) {
+            return s1.at < s2.at;
+        }
+    };
+
+    Dictionary& dictionary_;
+    unsigned threads_;
+    StreetNormalizer normalizer_;
+    std::unordered_map<int, Slot> slots_;
+    int next_seq_ = 0;
+
+    std::vector<std::vector<Stop>> lines_;
+    std::vector<double> mst_;
+    std::vector<bool> dirty_;
+
+    Interner names_;
+    std::vector<std::set<Occurrence>> streets_;
+    std::vector<std::vector<int>> normalized_;
+    std::vector<bool> normalized_done_;
+    std::vector<std::string> short_streets_;
+
+    static int decode_number(char* begin, char* end) {
+        int number = 0;
+        for_each_field(begin, end, [&](std::string_view name, char* value_begin, char* value_end) {
+            if (name == "number") {
+                std::string_view value = trim(xml_unescape(value_begin, value_end));
+                std::from_chars(value.data(), value.data() + value.size(), number);
+            }
+        });
+        return number;
+    }
+
+    // lines of a type that still have stations
+    std::vector<int> lines_of_type(std::string_view type) const {
+        int id = dictionary_.types.find(type);
+        std::vector<int> ans;
+        for (int line = 0; id >= 0 && line < int(lines_.size()); ++line) {
+            if (!lines_[line].empty() && dictionary_.line_type(line) == id) {
+                ans.push_back(line);
+            }
+        }
+        return ans;
+    }
+
+    std::string_view route_name(int line) const {
+        return dictionary_.routes.name(dictionary_.line_route(line));
+    }
+
+    static bool better(double value1, const Occurrence& first1, double value2, const Occurrence& first2) {
+        return value1 > value2 || (value1 == value2 && first1 < first2);
+    }
+
+    template<class Value>
+    std::vector<int> champions(Value value) const {
+        std::vector<int> best (dictionary_.types.size(), -1);
+        for (int line = 0; line < int(lines_.size()); ++line) {
+            if (lines_[line].empty()) {
+                continue;
+            }
+            int& champ = best[dictionary_.line_type(line)];
+            if (champ < 0 || better(value(line), lines_[line].front().at, value(champ), lines_[champ].front().at)) {
+                champ = line;
+            }
+        }
+        return best;
+    }
+
+    void touch(int line) {
+        if (line >= int(lines_.size())) {
+            lines_.resize(line + 1);
+            mst_.resize(line + 1, 0);
+            dirty_.resize(line + 1, false);
+        }
+        dirty_[line] = true;
+    }
+
+    const std::vector<int>& normalized(int street) {
+        if (street >= int(normalized_done_.size())) {
+            normalized_done_.resize(street + 1, false);
+            normalized_.resize(street + 1);
+        }
+        if (!normalized_done_[street]) {
+            normalizer_.normalize(dictionary_.streets.name(street), short_streets_);
+            for (const std::string& short_street : short_streets_) {
+                normalized_[street].push_back(names_.intern(short_street));
+            }
+            normalized_done_[street] = true;
+        }
+        return normalized_[street];
+    }
+
+    void apply(const Slot& slot) {
+        for (int i = 0; i < int(slot.lines.size()); ++i) {
+            int line = slot.lines[i];
+            touch(line);
+            Stop stop {Occurrence(slot.seq, i, 0), slot.coords};
+            std::vector<Stop>& stops = lines_[line];
+            stops.insert(std::upper_bound(stops.begin(), stops.end(), stop), stop);
+        }
+        for (int i = 0; i < int(slot.streets.size()); ++i) {
+            const std::vector<int>& names = normalized(slot.streets[i]);
+            for (int j = 0; j < int(names.size()); ++j) {
+                if (names[j] >= int(streets_.size())) {
+                    streets_.resize(names[j] + 1);
+                }
+                streets_[names[j]].insert(Occurrence(slot.seq, i, j));
+            }
+        }
+    }
+
+    void retract(const Slot& slot) {
+        for (int i = 0; i < int(slot.lines.size()); ++i) {
+            int line = slot.lines[i];
+            touch(line);
+            std::vector<Stop>& stops = lines_[line];
+            Stop stop {Occurrence(slot.seq, i, 0), slot.coords};
+            auto it = std::lower_bound(stops.begin(), stops.end(), stop);
+            if (it != stops.end() && it->at == stop.at) {
+                stops.erase(it);
+            }
+        }
+        for (int i = 0; i < int(slot.streets.size()); ++i) {
+            const std::vector<int>& names = normalized(slot.streets[i]);
+            for (int j = 0; j < int(names.size()); ++j) {
+                streets_[names[j]].erase(Occurrence(slot.seq, i, j));
+            }
+        }
+    }
+
+    // Recomputes the MST of every line touched since the last call.
+    void update_mst() {
+        std::vector<int> jobs;
+        for (int line = 0; line < int(dirty_.size()); ++line) {
+            if (dirty_[line]) {
+                jobs.push_back(line);
+                dirty_[line] = false;
+            }
+        }
+        parallel_for(jobs.size(), [&](int i) {
+            std::vector<std::pair<double, double>> points;
+            points.reserve(lines_[jobs[i]].size());
+            for (const Stop& stop : lines_[jobs[i]]) {
+                points.push_back(stop.coords);
+            }
+            mst_[jobs[i]] = points.empty() ? 0 : geo_mst_weight(points);
+        }, threads_);
+    }
+};
+
+#endif
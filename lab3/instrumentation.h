@@ -0,0 +1,147 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "memory_usage.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Heap allocations through operator new, counted only while enabled; see allocation_counter.h.
+struct AllocationCounter {
+    static inline std::atomic<bool> enabled {false};
+    static inline std::atomic<std::size_t> count {0};
+    static inline std::atomic<std::size_t> bytes {0};
+};
+
+// User plus system time of all threads of the process, in seconds.
+inline double process_cpu_seconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    auto seconds = [](const FILETIME& t) {
+        return ((unsigned long long)(t.dwHighDateTime) << 32 | t.dwLowDateTime) * 1e-7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](const timeval& t) {
+        return t.tv_sec + t.tv_usec * 1e-6;
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#endif
+}
+
+struct PhaseStats {
+    std::string name;
+    double wall_seconds = 0;
+    double cpu_seconds = 0;
+    std::size_t allocations = 0;
+    std::size_t allocated_bytes = 0;
+    std::size_t peak_rss_bytes = 0;
+};
+
+// Per-phase wall and CPU time, allocations and peak RSS. A disabled profiler does nothing
+// but test a flag when a phase starts and ends.
+class Profiler {
+public:
+    // Measures from construction to destruction.
+    class Phase {
+    public:
+        Phase(Profiler& profiler, const char* name) : profiler_(profiler.enabled_ ? &profiler : nullptr) {
+            if (profiler_) {
+                stats_.name = name;
+                wall_ = std::chrono::steady_clock::now();
+                cpu_ = process_cpu_seconds();
+                allocations_ = AllocationCounter::count.load(std::memory_order_relaxed);
+                bytes_ = AllocationCounter::bytes.load(std::memory_order_relaxed);
+            }
+        }
+
+        Phase(const Phase&) = delete;
+
+        Phase& operator=(const Phase&) = delete;
+
+        ~Phase() {
+            if (profiler_) {
+                stats_.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_).count();
+                stats_.cpu_seconds = process_cpu_seconds() - cpu_;
+                stats_.allocations = AllocationCounter::count.load(std::memory_order_relaxed) - allocations_;
+                stats_.allocated_bytes = AllocationCounter::bytes.load(std::memory_order_relaxed) - bytes_;
+                stats_.peak_rss_bytes = peak_rss_bytes();
+                profiler_->phases_.push_back(std::move(stats_));
+            }
+        }
+
+    private:
+        Profiler* profiler_;
+        PhaseStats stats_;
+        std::chrono::steady_clock::time_point wall_;
+        double cpu_ = 0;
+        std::size_t allocations_ = 0;
+        std::size_t bytes_ = 0;
+    };
+
+    explicit Profiler(bool enabled = false) {
+        enable(enabled);
+    }
+
+    void enable(bool enabled) {
+        enabled_ = enabled;
+        AllocationCounter::enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+    const std::vector<PhaseStats>& phases() const {
+        return phases_;
+    }
+
+    void write_text(std::ostream& out) const {
+        out << std::left << std::setw(10) << "phase" << std::right << std::setw(10) << "wall,s"
+            << std::setw(10) << "cpu,s" << std::setw(12) << "allocs" << std::setw(14) << "alloc,KB"
+            << std::setw(14) << "peak RSS,KB" << std::endl;
+        for (const PhaseStats& phase : phases_) {
+            out << std::left << std::setw(10) << phase.name << std::right << std::fixed << std::setprecision(4)
+                << std::setw(10) << phase.wall_seconds << std::setw(10) << phase.cpu_seconds
+                << std::setw(12) << phase.allocations << std::setw(14) << phase.allocated_bytes / 1024
+                << std::setw(14) << phase.peak_rss_bytes / 1024 << std::defaultfloat << std::endl;
+        }
+    }
+
+    // {"phases": [{"name": ..., "wall_seconds": ..., ...}, ...]}; phase names are plain
+    // identifiers, so nothing needs escaping.
+    void write_json(std::ostream& out) const {
+        out << "{\"phases\": [";
+        for (std::size_t i = 0; i < phases_.size(); ++i) {
+            const PhaseStats& phase = phases_[i];
+            out << (i ? ", " : "") << "{\"name\": \"" << phase.name << "\""
+                << std::setprecision(9)
+                << ", \"wall_seconds\": " << phase.wall_seconds
+                << ", \"cpu_seconds\": " << phase.cpu_seconds
+                << ", \"allocations\": " << phase.allocations
+                << ", \"allocated_bytes\": " << phase.allocated_bytes
+                << ", \"peak_rss_bytes\": " << phase.peak_rss_bytes << "}";
+        }
+        out << "]}" << std::endl;
+    }
+
+private:
+    bool enabled_ = false;
+    std::vector<PhaseStats> phases_;
+};
+
+#endif
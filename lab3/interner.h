@@ -0,0 +1,172 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+// Maps strings to dense ids 0, 1, 2... in order of first appearance. Strings are copied
+// once into a single arena; lookups go through an open-addressing table of ids.
+class Interner {
+public:
+    int find(std::string_view s) const {
+        if (slots_.empty()) {
+            return -1;
+        }
+        std::size_t hash = std::hash<std::string_view>()(s);
+        for (std::size_t i = hash & mask(); ; i = (i + 1) & mask()) {
+            int id = slots_[i];
+            if (id < 0) {
+                return -1;
+            }
+            if (hashes_[id] == hash && name(id) == s) {
+                return id;
+            }
+        }
+    }
+
+    int intern(std::string_view s) {
+        if (std::size_t(size() + 1)*2 > slots_.size()) {
+            grow();
+        }
+        std::size_t hash = std::hash<std::string_view>()(s);
+        std::size_t i = hash & mask();
+        for (; slots_[i] >= 0; i = (i + 1) & mask()) {
+            int id = slots_[i];
+            if (hashes_[id] == hash && name(id) == s) {
+                return id;
+            }
+        }
+        int id = size();
+        slots_[i] = id;
+        hashes_.push_back(hash);
+        bytes_ += s;
+        begin_.push_back(bytes_.size());
+        return id;
+    }
+
+    // Valid until the next intern() call.
+    std::string_view name(int id) const {
+        return std::string_view(bytes_.data() + begin_[id], begin_[id + 1] - begin_[id]);
+    }
+
+    int size() const {
+        return hashes_.size();
+    }
+
+    const std::vector<std::uint64_t>& offsets() const {
+        return begin_;
+    }
+
+    const std::string& bytes() const {
+        return bytes_;
+    }
+
+private:
+    std::vector<int> slots_;
+    std::vector<std::size_t> hashes_;
+    std::vector<std::uint64_t> begin_ {0};
+    std::string bytes_;
+
+    std::size_t mask() const {
+        return slots_.size() - 1;
+    }
+
+    void grow() {
+        slots_.assign(std::max<std::size_t>(16, slots_.size()*2), -1);
+        for (int id = 0; id < size(); ++id) {
+            std::size_t i = hashes_[id] & mask();
+            while (slots_[i] >= 0) {
+                i = (i + 1) & mask();
+            }
+            slots_[i] = id;
+        }
+    }
+};
+
+// Dense ids for pairs of ids, e.g. a (vehicle type, route) line.
+class PairInterner {
+public:
+    int find(int first, int second) const {
+        if (slots_.empty()) {
+            return -1;
+        }
+        std::uint64_t key = pack(first, second);
+        for (std::size_t i = hash(key) & mask(); ; i = (i + 1) & mask()) {
+            int id = slots_[i];
+            if (id < 0) {
+                return -1;
+            }
+            if (pack(first_[id], second_[id]) == key) {
+                return id;
+            }
+        }
+    }
+
+    int intern(int first, int second) {
+        if (std::size_t(size() + 1)*2 > slots_.size()) {
+            grow();
+        }
+        std::uint64_t key = pack(first, second);
+        std::size_t i = hash(key) & mask();
+        for (; slots_[i] >= 0; i = (i + 1) & mask()) {
+            int id = slots_[i];
+            if (pack(first_[id], second_[id]) == key) {
+                return id;
+            }
+        }
+        int id = size();
+        slots_[i] = id;
+        first_.push_back(first);
+        second_.push_back(second);
+        return id;
+    }
+
+    int first(int id) const {
+        return first_[id];
+    }
+
+    int second(int id) const {
+        return second_[id];
+    }
+
+    int size() const {
+        return first_.size();
+    }
+
+private:
+    std::vector<int> slots_;
+    std::vector<int> first_;
+    std::vector<int> second_;
+
+    static std::uint64_t pack(int first, int second) {
+        return (std::uint64_t(std::uint32_t(first)) << 32) | std::uint32_t(second);
+    }
+
+    static std::size_t hash(std::uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    std::size_t mask() const {
+        return slots_.size() - 1;
+    }
+
+    void grow() {
+        slots_.assign(std::max<std::size_t>(16, slots_.size()*2), -1);
+        for (int id = 0; id < size(); ++id) {
+            std::size_t i = hash(pack(first_[id], second_[id])) & mask();
+            while (slots_[i] >= 0) {
+                i = (i + 1) & mask();
+            }
+            slots_[i] = id;
+        }
+    }
+};
+
+#endif
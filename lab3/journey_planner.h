@@ -0,0 +1,465 @@
+#ifndef JOURNEY_PLANNER_H
+#define JOURNEY_PLANNER_H
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <tuple>
+
+#include "scan.h"
+#include "kdtree.h"
+#include "station_index.h"
+#include "station_coords.h"
+
+// One leg of a journey between two stations (indices in scan order); line is a Dictionary
+// line id, or -1 for walking.
+struct JourneyLeg {
+    int line;
+    int from;
+    int to;
+    double meters;
+};
+
+struct Journey {
+    bool found = false;
+    int transfers = 0;
+    double meters = 0;
+    std::vector<JourneyLeg> legs;
+};
+
+// Journeys over the stops of a scan. The feed has no stop order, so a line is ridden along
+// the minimum spanning tree of its stops -- the same model as the route length of task 2 --
+// and stops closer than the walking radius are linked by walking transfers.
+//
+// build() precomputes the station graph (tree edges of every line plus walking edges) and
+// the line graph, where two lines are adjacent if one can change between them at a shared
+// stop or with a single walk. Fewest-transfer queries are a breadth-first search over the
+// line graph; shortest-distance queries are A* over the station graph with the straight
+// line distance to the target as the bound.
+class JourneyPlanner : public Aggregator {
+public:
+    explicit JourneyPlanner(double walk_meters = 300) : walk_meters_(walk_meters) {}
+
+    void consume(const Station& station) override {
+        index_.consume(station);
+        if (!numbers_.count(station.number)) {
+            numbers_[station.number] = lines_.size();
+        }
+        std::vector<int> lines = station.lines;
+        std::sort(lines.begin(), lines.end());
+        lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+        lines_.push_back(std::move(lines));
+        built_ = false;
+    }
+
+    void build() {
+        index_.build();
+        int n = lines_.size();
+        units_.clear();
+        for (int s = 0; s < n; ++s) {
+            units_.push_back(unit_vector(index_.coords(s)));
+        }
+
+        int n_lines = 0;
+        for (const std::vector<int>& lines : lines_) {
+            for (int line : lines) {
+                n_lines = std::max(n_lines, line + 1);
+            }
+        }
+        stops_.assign(n_lines, {});
+        for (int s = 0; s < n; ++s) {
+            for (int line : lines_[s]) {
+                stops_[line].push_back(s);
+            }
+        }
+
+        std::vector<std::vector<Edge>> adjacent (n);
+        trees_.assign(n_lines, {});
+        for (int line = 0; line < n_lines; ++line) {
+            build_tree(line);
+            const Tree& tree = trees_[line];
+            for (int v = 0; v < int(tree.parent.size()); ++v) {
+                if (tree.parent[v] >= 0) {
+                    int a = stops_[line][v];
+                    int b = stops_[line][tree.parent[v]];
+                    double meters = tree.meters[v] - tree.meters[tree.parent[v]];
+                    adjacent[a].push_back(Edge {b, line, meters});
+                    adjacent[b].push_back(Edge {a, line, meters});
+                }
+            }
+        }
+
+        walks_.assign(n, {});
+        std::vector<Transfer> transfers;
+        for (int s = 0; s < n; ++s) {
+            for (const StationHit& hit : index_.within(index_.coords(s), walk_meters_)) {
+                if (hit.station != s) {
+                    walks_[s].push_back(hit);
+                    adjacent[s].push_back(Edge {hit.station, -1, hit.meters});
+                }
+                for (int from : lines_[s]) {
+                    for (int to : lines_[hit.station]) {
+                        if (from != to) {
+                            transfers.push_back(Transfer {from, to, s, hit.station, hit.meters});
+                        }
+                    }
+                }
+            }
+        }
+
+        edge_begin_.assign(1, 0);
+        edges_.clear();
+        for (std::vector<Edge>& list : adjacent) {
+            edges_.insert(edges_.end(), list.begin(), list.end());
+            edge_begin_.push_back(edges_.size());
+        }
+
+        // the shortest walk for every pair of lines
+        std::sort(transfers.begin(), transfers.end(), [](const Transfer& t1, const Transfer& t2) {
+            return std::tie(t1.from, t1.to, t1.meters, t1.alight, t1.board) < std::tie(t2.from, t2.to, t2.meters, t2.alight, t2.board);
+        });
+        transfers.erase(std::unique(transfers.begin(), transfers.end(), [](const Transfer& t1, const Transfer& t2) {
+            return t1.from == t2.from && t1.to == t2.to;
+        }), transfers.end());
+        transfers_ = std::move(transfers);
+        transfer_begin_.assign(n_lines + 1, 0);
+        for (const Transfer& transfer : transfers_) {
+            transfer_begin_[transfer.from + 1]++;
+        }
+        for (int line = 0; line < n_lines; ++line) {
+            transfer_begin_[line + 1] += transfer_begin_[line];
+        }
+        built_ = true;
+    }
+
+    // Station index for a station number, -1 if there is none.
+    int station(int number) const {
+        auto it = numbers_.find(number);
+        return it == numbers_.end() ? -1 : it->second;
+    }
+
+    const StationIndex& index() const {
+        return index_;
+    }
+
+    // Fewest boardings, starting from the closest stop that has a line; every change of
+    // line is one walk within the radius. Stations within walking distance of each other
+    // need no boarding at all.
+    Journey fewest_transfers(int from, int to) {
+        ensure_built();
+        Journey ans;
+        if (from == to || is_walk(from, to)) {
+            return walk_only(from, to);
+        }
+        int n_lines = stops_.size();
+        std::vector<int> board (n_lines, -1);
+        std::vector<int> via (n_lines, -1);
+        std::vector<int> order;
+        for (const StationHit& hit : access(from)) {
+            for (int line : lines_[hit.station]) {
+                if (board[line] < 0) {
+                    board[line] = hit.station;
+                    order.push_back(line);
+                }
+            }
+        }
+        std::vector<StationHit> egress = access(to);
+        std::vector<int> alight (n_lines, -1);
+        for (const StationHit& hit : egress) {
+            for (int line : lines_[hit.station]) {
+                if (alight[line] < 0) {
+                    alight[line] = hit.station;
+                }
+            }
+        }
+
+        for (std::size_t head = 0; head < order.size(); ++head) {
+            int line = order[head];
+            if (alight[line] >= 0) {
+                return assemble(from, to, line, alight[line], board, via);
+            }
+            for (int t = transfer_begin_[line]; t < transfer_begin_[line + 1]; ++t) {
+                int next = transfers_[t].to;
+                if (board[next] < 0) {
+                    board[next] = transfers_[t].board;
+                    via[next] = t;
+                    order.push_back(next);
+                }
+            }
+        }
+        return ans;
+    }
+
+    // Shortest total distance, riding and walking.
+    Journey shortest(int from, int to) {
+        ensure_built();
+        int n = lines_.size();
+        std::vector<double> dist (n, std::numeric_limits<double>::infinity());
+        std::vector<int> pred (n, -1);
+        using Item = std::pair<double, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        dist[from] = 0;
+        queue.emplace(bound(from, to), from);
+        while (!queue.empty()) {
+            auto [f, u] = queue.top();
+            queue.pop();
+            if (u == to) {
+                break;
+            }
+            if (f > dist[u] + bound(u, to)) {
+                continue;
+            }
+            for (int e = edge_begin_[u]; e < edge_begin_[u + 1]; ++e) {
+                const Edge& edge = edges_[e];
+                double d = dist[u] + edge.meters;
+                if (d < dist[edge.to]) {
+                    dist[edge.to] = d;
+                    pred[edge.to] = e;
+                    queue.emplace(d + bound(edge.to, to), edge.to);
+                }
+            }
+        }
+        Journey ans;
+        if (dist[to] == std::numeric_limits<double>::infinity()) {
+            return ans;
+        }
+        std::vector<JourneyLeg> steps;
+        for (int v = to; v != from;) {
+            const Edge& edge = edges_[pred[v]];
+            int u = source(pred[v]);
+            steps.push_back(JourneyLeg {edge.line, u, v, edge.meters});
+            v = u;
+        }
+        std::reverse(steps.begin(), steps.end());
+        relabel(steps);
+        ans.found = true;
+        for (const JourneyLeg& step : steps) {
+            if (!ans.legs.empty() && ans.legs.back().line == step.line) {
+                ans.legs.back().to = step.to;
+                ans.legs.back().meters += step.meters;
+            } else {
+                ans.legs.push_back(step);
+            }
+        }
+        finish(ans);
+        return ans;
+    }
+
+private:
+    struct Edge {
+        int to;
+        int line;
+        double meters;
+    };
+
+    struct Transfer {
+        int from;
+        int to;
+        int alight;
+        int board;
+        double meters;
+    };
+
+    // Spanning tree of a line's stops: parent and distance from the root along the tree,
+    // both by position in stops_[line].
+    struct Tree {
+        std::vector<int> parent;
+        std::vector<int> depth;
+        std::vector<double> meters;
+    };
+
+    double walk_meters_;
+    StationIndex index_;
+    std::unordered_map<int, int> numbers_;
+    std::vector<std::vector<int>> lines_;
+    std::vector<Vec3> units_;
+    std::vector<std::vector<int>> stops_;
+    std::vector<Tree> trees_;
+    std::vector<std::vector<StationHit>> walks_;
+    std::vector<int> edge_begin_;
+    std::vector<Edge> edges_;
+    std::vector<int> transfer_begin_;
+    std::vector<Transfer> transfers_;
+    bool built_ = false;
+
+    void ensure_built() {
+        if (!built_) {
+            build();
+        }
+    }
+
+    double bound(int u, int v) const {
+        return chord2_to_meters(dist2(units_[u], units_[v]));
+    }
+
+    int source(int edge) const {
+        return std::upper_bound(edge_begin_.begin(), edge_begin_.end(), edge) - edge_begin_.begin() - 1;
+    }
+
+    // Dense Prim over the line's stops, keeping the tree rather than its weight.
+    void build_tree(int line) {
+        const std::vector<int>& stops = stops_[line];
+        int n = stops.size();
+        Tree& tree = trees_[line];
+        tree.parent.assign(n, -1);
+        tree.depth.assign(n, 0);
+        tree.meters.assign(n, 0);
+        std::vector<double> keys (n, std::numeric_limits<double>::infinity());
+        std::vector<bool> in_tree (n, false);
+        std::vector<int> order;
+        if (n > 0) {
+            keys[0] = 0;
+        }
+        for (int step = 0; step < n; ++step) {
+            int u = -1;
+            for (int v = 0; v < n; ++v) {
+                if (!in_tree[v] && (u < 0 || keys[v] < keys[u])) {
+                    u = v;
+                }
+            }
+            in_tree[u] = true;
+            if (tree.parent[u] >= 0) {
+                tree.depth[u] = tree.depth[tree.parent[u]] + 1;
+                tree.meters[u] = tree.meters[tree.parent[u]] + chord2_to_meters(keys[u]);
+            }
+            for (int v = 0; v < n; ++v) {
+                if (!in_tree[v]) {
+                    double d2 = dist2(units_[stops[u]], units_[stops[v]]);
+                    if (d2 < keys[v]) {
+                        keys[v] = d2;
+                        tree.parent[v] = u;
+                    }
+                }
+            }
+        }
+    }
+
+    bool has_tree_edge(int line, int a, int b) const {
+        const std::vector<int>& stops = stops_[line];
+        const Tree& tree = trees_[line];
+        auto u = std::find(stops.begin(), stops.end(), a);
+        auto v = std::find(stops.begin(), stops.end(), b);
+        if (u == stops.end() || v == stops.end()) {
+            return false;
+        }
+        return tree.parent[u - stops.begin()] == v - stops.begin() || tree.parent[v - stops.begin()] == u - stops.begin();
+    }
+
+    // Lines share tree edges, and the search keeps whichever it relaxed first; along every
+    // run of rides stay on the line that covers the most of the run before changing.
+    void relabel(std::vector<JourneyLeg>& steps) const {
+        for (std::size_t i = 0; i < steps.size();) {
+            if (steps[i].line < 0) {
+                ++i;
+                continue;
+            }
+            std::size_t best_end = i + 1;
+            for (int line : lines_[steps[i].from]) {
+                std::size_t end = i;
+                while (end < steps.size() && steps[end].line >= 0 && has_tree_edge(line, steps[end].from, steps[end].to)) {
+                    ++end;
+                }
+                if (end > best_end || (end == best_end && line == steps[i].line)) {
+                    best_end = end;
+                    for (std::size_t j = i; j < end; ++j) {
+                        steps[j].line = line;
+                    }
+                }
+            }
+            i = best_end;
+        }
+    }
+
+    // Distance between two stops of a line along its tree.
+    double ride_meters(int line, int from, int to) const {
+        const std::vector<int>& stops = stops_[line];
+        const Tree& tree = trees_[line];
+        int u = std::find(stops.begin(), stops.end(), from) - stops.begin();
+        int v = std::find(stops.begin(), stops.end(), to) - stops.begin();
+        double ans = tree.meters[u] + tree.meters[v];
+        while (u != v) {
+            if (tree.depth[u] < tree.depth[v]) {
+                std::swap(u, v);
+            }
+            u = tree.parent[u];
+        }
+        return ans - 2*tree.meters[u];
+    }
+
+    bool is_walk(int from, int to) const {
+        for (const StationHit& hit : walks_[from]) {
+            if (hit.station == to) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The station itself, then the stations within walking distance, closest first.
+    std::vector<StationHit> access(int station) const {
+        std::vector<StationHit> ans {StationHit {station, 0}};
+        ans.insert(ans.end(), walks_[station].begin(), walks_[station].end());
+        return ans;
+    }
+
+    Journey walk_only(int from, int to) const {
+        Journey ans;
+        ans.found = true;
+        if (from != to) {
+            ans.legs.push_back(JourneyLeg {-1, from, to, bound(from, to)});
+        }
+        finish(ans);
+        return ans;
+    }
+
+    Journey assemble(int from, int to, int last, int alight, const std::vector<int>& board, const std::vector<int>& via) const {
+        std::vector<JourneyLeg> legs;
+        auto walk = [&](int a, int b) {
+            if (a != b) {
+                legs.push_back(JourneyLeg {-1, a, b, bound(a, b)});
+            }
+        };
+        auto ride = [&](int line, int a, int b) {
+            if (a != b) {
+                legs.push_back(JourneyLeg {line, a, b, ride_meters(line, a, b)});
+            }
+        };
+        walk(to, alight);
+        for (int line = last; line >= 0;) {
+            ride(line, alight, board[line]);
+            if (via[line] < 0) {
+                walk(board[line], from);
+                break;
+            }
+            const Transfer& transfer = transfers_[via[line]];
+            walk(board[line], transfer.alight);
+            alight = transfer.alight;
+            line = transfer.from;
+        }
+        // collected from the target backwards
+        std::reverse(legs.begin(), legs.end());
+        Journey ans;
+        ans.found = true;
+        for (JourneyLeg leg : legs) {
+            std::swap(leg.from, leg.to);
+            ans.legs.push_back(leg);
+        }
+        finish(ans);
+        return ans;
+    }
+
+    static void finish(Journey& journey) {
+        int rides = 0;
+        journey.meters = 0;
+        for (const JourneyLeg& leg : journey.legs) {
+            rides += leg.line >= 0;
+            journey.meters += leg.meters;
+        }
+        journey.transfers = std::max(0, rides - 1);
+    }
+};
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <utility>
+
+using Vec3 = std::array<double, 3>;
+
+inline double dist2(const Vec3& a, const Vec3& b) {
+    double dx = a[0] - b[0];
+    double dy = a[1] - b[1];
+    double dz = a[2] - b[2];
+    return dx*dx + dy*dy + dz*dz;
+}
+
+// Static 3-d tree over a point set. Queries report indices into the original vector.
+class KdTree {
+public:
+    static const int leaf_size = 8;
+
+    explicit KdTree(std::vector<Vec3> points) : order_(points.size()) {
+        std::iota(order_.begin(), order_.end(), 0);
+        if (!points.empty()) {
+            build(points, 0, points.size());
+        }
+        points_.reserve(points.size());
+        for (int i : order_) {
+            points_.push_back(points[i]);
+        }
+    }
+
+    int size() const {
+        return order_.size();
+    }
+
+    int node_count() const {
+        return nodes_.size();
+    }
+
+    // For every node, the label shared by all of its points, or -1 if they differ.
+    std::vector<int> uniform_labels(const std::vector<int>& point_labels) const {
+        std::vector<int> labels (nodes_.size());
+        for (int i = int(nodes_.size()) - 1; i >= 0; --i) {
+            const Node& node = nodes_[i];
+            if (node.left < 0) {
+                int label = point_labels[order_[node.begin]];
+                for (int j = node.begin + 1; j < node.end && label >= 0; ++j) {
+                    if (point_labels[order_[j]] != label) {
+                        label = -1;
+                    }
+                }
+                labels[i] = label;
+            } else {
+                labels[i] = labels[node.left] == labels[node.right] ? labels[node.left] : -1;
+            }
+        }
+        return labels;
+    }
+
+    // Improves (best, best_d2) with the nearest accepted point to q; ties go to the lower index.
+    // skip_node(node) prunes whole subtrees, accept(index) filters single points.
+    template<class Skip, class Accept>
+    void nearest(const Vec3& q, Skip skip_node, Accept accept, int& best, double& best_d2) const {
+        if (!nodes_.empty()) {
+            nearest(0, q, skip_node, accept, best, best_d2);
+        }
+    }
+
+    // The k nearest accepted points as (squared distance, index), closest first.
+    template<class Accept>
+    std::vector<std::pair<double, int>> k_nearest(const Vec3& q, int k, Accept accept) const {
+        std::vector<std::pair<double, int>> heap;
+        if (k > 0 && !nodes_.empty()) {
+            k_nearest(0, q, k, accept, heap);
+        }
+        std::sort_heap(heap.begin(), heap.end());
+        return heap;
+    }
+
+    // Calls f(index, squared distance) for every accepted point within sqrt(r2) of q.
+    template<class Accept, class F>
+    void within(const Vec3& q, double r2, Accept accept, F f) const {
+        if (!nodes_.empty()) {
+            within(0, q, r2, accept, f);
+        }
+    }
+
+    int nearest(const Vec3& q) const {
+        int best = -1;
+        double best_d2 = std::numeric_limits<double>::infinity();
+        nearest(q, [](int) { return false; }, [](int) { return true; }, best, best_d2);
+        return best;
+    }
+
+private:
+    struct Node {
+        int begin;
+        int end;
+        int left;
+        int right;
+        Vec3 lo;
+        Vec3 hi;
+    };
+
+    std::vector<int> order_;
+    std::vector<Vec3> points_;
+    std::vector<Node> nodes_;
+
+    int build(const std::vector<Vec3>& points, int begin, int end) {
+        Vec3 lo = points[order_[begin]];
+        Vec3 hi = lo;
+        for (int i = begin + 1; i < end; ++i) {
+            for (int d = 0; d < 3; ++d) {
+                lo[d] = std::min(lo[d], points[order_[i]][d]);
+                hi[d] = std::max(hi[d], points[order_[i]][d]);
+            }
+        }
+        int id = nodes_.size();
+        nodes_.push_back(Node {begin, end, -1, -1, lo, hi});
+        if (end - begin > leaf_size) {
+            int dim = 0;
+            for (int d = 1; d < 3; ++d) {
+                if (hi[d] - lo[d] > hi[dim] - lo[dim]) {
+                    dim = d;
+                }
+            }
+            int mid = (begin + end) / 2;
+            std::nth_element(order_.begin() + begin, order_.begin() + mid, order_.begin() + end, [&](int a, int b) {
+                return points[a][dim] < points[b][dim];
+            });
+            int left = build(points, begin, mid);
+            int right = build(points, mid, end);
+            nodes_[id].left = left;
+            nodes_[id].right = right;
+        }
+        return id;
+    }
+
+    double box_dist2(const Node& node, const Vec3& q) const {
+        double sum = 0;
+        for (int d = 0; d < 3; ++d) {
+            double diff = std::max({node.lo[d] - q[d], 0.0, q[d] - node.hi[d]});
+            sum += diff*diff;
+        }
+        return sum;
+    }
+
+    template<class Skip, class Accept>
+    void nearest(int id, const Vec3& q, Skip& skip_node, Accept& accept, int& best, double& best_d2) const {
+        const Node& node = nodes_[id];
+        if (skip_node(id) || box_dist2(node, q) > best_d2) {
+            return;
+        }
+        if (node.left < 0) {
+            for (int i = node.begin; i < node.end; ++i) {
+                int index = order_[i];
+                double d2 = dist2(points_[i], q);
+                if ((d2 < best_d2 || (d2 == best_d2 && (best < 0 || index < best))) && accept(index)) {
+                    best = index;
+                    best_d2 = d2;
+                }
+            }
+            return;
+        }
+        int first = node.left;
+        int second = node.right;
+        if (box_dist2(nodes_[second], q) < box_dist2(nodes_[first], q)) {
+            std::swap(first, second);
+        }
+        nearest(first, q, skip_node, accept, best, best_d2);
+        nearest(second, q, skip_node, accept, best, best_d2);
+    }
+
+    template<class Accept>
+    void k_nearest(int id, const Vec3& q, int k, Accept& accept, std::vector<std::pair<double, int>>& heap) const {
+        const Node& node = nodes_[id];
+        if (int(heap.size()) == k && box_dist2(node, q) > heap.front().first) {
+            return;
+        }
+        if (node.left < 0) {
+            for (int i = node.begin; i < node.end; ++i) {
+                std::pair<double, int> candidate (dist2(points_[i], q), order_[i]);
+                if (int(heap.size()) == k && !(candidate < heap.front())) {
+                    continue;
+                }
+                if (!accept(candidate.second)) {
+                    continue;
+                }
+                if (int(heap.size()) == k) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.pop_back();
+                }
+                heap.push_back(candidate);
+                std::push_heap(heap.begin(), heap.end());
+            }
+            return;
+        }
+        int first = node.left;
+        int second = node.right;
+        if (box_dist2(nodes_[second], q) < box_dist2(nodes_[first], q)) {
+            std::swap(first, second);
+        }
+        k_nearest(first, q, k, accept, heap);
+        k_nearest(second, q, k, accept, heap);
+    }
+
+    template<class Accept, class F>
+    void within(int id, const Vec3& q, double r2, Accept& accept, F& f) const {
+        const Node& node = nodes_[id];
+        if (box_dist2(node, q) > r2) {
+            return;
+        }
+        if (node.left < 0) {
+            for (int i = node.begin; i < node.end; ++i) {
+                double d2 = dist2(points_[i], q);
+                if (d2 <= r2 && accept(order_[i])) {
+                    f(order_[i], d2);
+                }
+            }
+            return;
+        }
+        within(node.left, q, r2, accept, f);
+        within(node.right, q, r2, accept, f);
+    }
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "query_server.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Resident query server over the tables of lab3:
+//     lab3_server [--feed data.xml] [--socket PATH] [--poll MS] [--streets FILE]
+// Queries are read one per line (see QueryServer) from stdin, or from every client of a
+// Unix socket; each answer is followed by an empty line. The feed is checked every MS
+// milliseconds (default 1000) and swapped for a fresh model when it changes. --streets
+// reads the street-type words cut from street names from FILE, one per line, as lab3 does.
+
+// Reloads the feed every poll interval on its own thread until destroyed; the destructor
+// wakes the thread and joins it, so it never outlives the server it reloads.
+class FeedWatcher {
+public:
+    FeedWatcher(QueryServer& server, int poll_ms)
+            : server_(server)
+            , poll_(poll_ms)
+            , thread_([this] { watch(); }) {}
+
+    FeedWatcher(const FeedWatcher&) = delete;
+    FeedWatcher& operator=(const FeedWatcher&) = delete;
+
+    ~FeedWatcher() {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            done_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+private:
+    QueryServer& server_;
+    std::chrono::milliseconds poll_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool done_ = false;
+    std::thread thread_;
+
+    void watch() {
+        std::unique_lock<std::mutex> lock (mutex_);
+        while (!wake_.wait_for(lock, poll_, [this] { return done_; })) {
+            lock.unlock();
+            server_.reload();
+            lock.lock();
+        }
+    }
+};
+
+#ifndef _WIN32
+void serve_client(const QueryServer& server, int client) {
+    std::string buffer;
+    char chunk[4096];
+    for (ssize_t n; (n = read(client, chunk, sizeof(chunk))) > 0;) {
+        buffer.append(chunk, n);
+        for (std::size_t eol; (eol = buffer.find('\n')) != std::string::npos;) {
+            std::string query = buffer.substr(0, eol);
+            buffer.erase(0, eol + 1);
+            if (query == "quit") {
+                close(client);
+                return;
+            }
+            std::string reply = server.answer(query) + "\n";
+            for (std::size_t sent = 0; sent < reply.size();) {
+                // EPIPE when the client hung up before reading: drop it
+                ssize_t m = write(client, reply.data() + sent, reply.size() - sent);
+                if (m <= 0) {
+                    close(client);
+                    return;
+                }
+                sent += m;
+            }
+        }
+    }
+    close(client);
+}
+
+bool serve_socket(const QueryServer& server, const std::string& path) {
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (listener < 0 || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    path.copy(address.sun_path, path.size());
+    unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 16) < 0) {
+        close(listener);
+        return false;
+    }
+    for (int client; (client = accept(listener, nullptr, nullptr)) >= 0;) {
+        std::thread(serve_client, std::cref(server), client).detach();
+    }
+    close(listener);
+    return true;
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::string feed = "data.xml";
+    std::string socket_path;
+    int poll_ms = 1000;
+    std::string streets_path;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--feed") {
+            feed = argv[i + 1];
+        } else if (arg == "--socket") {
+            socket_path = argv[i + 1];
+        } else if (arg == "--poll") {
+            poll_ms = std::stoi(argv[i + 1]);
+        } else if (arg == "--streets") {
+            streets_path = argv[i + 1];
+        }
+    }
+
+    StreetNormalizer normalizer;
+    if (!streets_path.empty()) {
+        std::ifstream words (streets_path);
+        if (!words) {
+            std::cout << "error loading " << streets_path << std::endl;
+            return 1;
+        }
+        normalizer = StreetNormalizer::load(words);
+    }
+
+    QueryServer server (feed, std::move(normalizer));
+    if (!server.reload()) {
+        std::cout << "error loading file" << std::endl;
+        return 1;
+    }
+
+    FeedWatcher watcher (server, poll_ms);
+
+    if (!socket_path.empty()) {
+#ifndef _WIN32
+        // a client that disconnects mid-reply must not take the daemon down with SIGPIPE
+        std::signal(SIGPIPE, SIG_IGN);
+        if (!serve_socket(server, socket_path)) {
+            std::cout << "error opening " << socket_path << std::endl;
+            return 1;
+        }
+#else
+        std::cout << "sockets are not supported on this platform" << std::endl;
+        return 1;
+#endif
+    }
+    for (std::string query; std::getline(std::cin, query) && query != "quit";) {
+        std::cout << server.answer(query) << std::endl;
+    }
+}
@@ -1,261 +1,273 @@
 #include <iostream>
+#include <fstream>
+#include <memory>
 #include <unordered_map>
-#include <unordered_set>
-#include <regex>
-#include <cmath>
+#include <string>
+#include <vector>
 
-#include "pugixml.hpp"
+#include "scan.h"
+#include "station_reader.h"
+#include "snapshot.h"
+#include "tasks.h"
+#include "route_metrics.h"
+#include "incremental.h"
+#include "ranking.h"
+#include "journey_planner.h"
+#include "stop_clusters.h"
+#include "instrumentation.h"
+#include "allocation_counter.h"
+#include "output.h"
 
-#include <windows.h>
-
-std::vector<std::string> split(const std::string& s, const std::regex& rgx, bool allow_empty) {
-    std::sregex_token_iterator iter (s.begin(), s.end(), rgx, -1);
-    std::sregex_token_iterator end;
-    std::vector<std::string> res;
-    for (; iter != end; ++iter) {
-        std::string word = *iter;
-        if (!word.empty() || allow_empty) {
-            res.push_back(word);
-        }
+// Russian noun form for a count: one for 1, 21, 31, ..., few for 2-4, 22-24, ..., many for
+// the rest, including 11-14.
+std::string_view plural(int n, std::string_view one, std::string_view few, std::string_view many) {
+    if (n % 100 >= 11 && n % 100 <= 14) {
+        return many;
     }
-    return res;
-}
-
-std::string join(const std::vector<std::string>& ss, const std::string& delim) {
-    std::string ans;
-    bool fst = true;
-    for (const std::string& s : ss) {
-        if (fst) {
-            fst = false;
-        } else {
-            ans += delim;
-        }
-        ans += s;
+    switch (n % 10) {
+        case 1:
+            return one;
+        case 2:
+        case 3:
+        case 4:
+            return few;
+        default:
+            return many;
     }
-    return ans;
 }
 
-double distance(const std::pair<double, double>& p1, const std::pair<double, double>& p2) {
-    static const double R = 6371000;
-    auto [lat1, lon1] = p1;
-    auto [lat2, lon2] = p2;
-    lat1 = lat1*M_PI/180;
-    lon1 = lon1*M_PI/180;
-    lat2 = lat2*M_PI/180;
-    lon2 = lon2*M_PI/180;
-    return R*2*std::asin(std::sqrt((1 - std::cos(lat1-lat2))/2 + std::cos(lat1)*std::cos(lat2)*(1 - std::cos(lon1-lon2))/2));
+std::string_view transfers(int n) {
+    return plural(n, "пересадка", "пересадки", "пересадок");
 }
 
-std::vector<std::string> get_routes(const std::string& full_routes_string) {
-    static const std::regex route_split_rgx (",");
-    static const std::regex route_cut_rgx ("\\.");
-    std::string routes_string = split(full_routes_string, route_cut_rgx, false)[0];
-    return split(routes_string, route_split_rgx, false);
+void print_journey(Output& out, const Journey& journey, const JourneyPlanner& planner, const Dictionary& dictionary) {
+    if (!journey.found) {
+        out << "no journey\n";
+        return;
+    }
+    out << journey.transfers << " " << transfers(journey.transfers) << ", " << journey.meters << " м.\n";
+    for (const JourneyLeg& leg : journey.legs) {
+        if (leg.line < 0) {
+            out << "  пешком";
+        } else {
+            out << "  " << dictionary.types.name(dictionary.line_type(leg.line)) << " " << dictionary.routes.name(dictionary.line_route(leg.line));
+        }
+        out << ": " << planner.index().number(leg.from) << " -> " << planner.index().number(leg.to)
+                  << " (" << leg.meters << " м.)\n";
+    }
 }
 
-template<class K, class V>
-bool comp_by_value(const std::pair<K,V>& p1, const std::pair<K,V>& p2) {
-    return p1.second < p2.second;
+std::string_view stations(int n) {
+    return plural(n, "остановка", "остановки", "остановок");
 }
 
-std::unordered_map<std::string, std::pair<std::string, int>> task1 (const pugi::xml_node& dataset) {
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> map;
-    for (pugi::xml_node station = dataset.first_child(); station; station = station.next_sibling()) {
-        std::string type = station.child_value("type_of_vehicle");
-        std::string full_routes_string = station.child_value("routes");
-        std::vector<std::string> routes = get_routes(full_routes_string);
-        if (!map.count(type)) {
-            map[type] = std::unordered_map<std::string, int> ();
-        }
-        for (const std::string& route : routes) {
-            if (!map[type].count(route)) {
-                map[type][route] = 0;
-            }
-            map[type][route]++;
+int main(int argc, char** argv) {
+    // lab3 [--top K] [--journey FROM TO] [--cluster METERS] [--streets FILE] [--profile]
+    //      [--profile-json FILE] [delta.xml...]:
+    // deltas are applied in order on top of data.xml, --top also lists the K best routes per
+    // type and streets after the deltas, --journey plans between two station numbers of
+    // data.xml, --cluster counts stations closer than METERS as one stop once the deltas
+    // are applied, --streets reads the street-type words cut from street names from FILE
+    // (one per line) instead of the built-in list, --profile prints per-phase time and
+    // memory to stderr and --profile-json writes them to FILE.
+    // Tasks 1 and 3 are counted during the scan, so most of their work shows up in "load".
+    std::vector<std::string> deltas;
+    int top = 0;
+    std::vector<std::pair<int, int>> journeys;
+    bool profile = false;
+    std::string profile_json;
+    double cluster_meters = 0;
+    std::string streets_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--profile-json" && i + 1 < argc) {
+            profile_json = argv[++i];
+        } else if (arg == "--cluster" && i + 1 < argc) {
+            cluster_meters = std::stod(argv[++i]);
+        } else if (arg == "--streets" && i + 1 < argc) {
+            streets_path = argv[++i];
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = std::stoi(argv[++i]);
+        } else if (arg == "--journey" && i + 2 < argc) {
+            int from = std::stoi(argv[++i]);
+            int to = std::stoi(argv[++i]);
+            journeys.emplace_back(from, to);
+        } else {
+            deltas.push_back(arg);
         }
     }
-    std::unordered_map<std::string, std::pair<std::string, int>> ans;
-    for (const auto& [type, routes] : map) {
-        ans[type] = *std::max_element(routes.begin(), routes.end(), comp_by_value<std::string, int>);
-    }
-    return ans;
-}
 
-double mst_weight(const std::vector<std::pair<double, double>>& points) {
-    int n = points.size();
-    std::vector<bool> in_set (n, false);
-    std::vector<double> keys (n, 1000000);
-    keys[0] = 0;
-    double ans = 0;
-    for (int i = 0; i < n; ++i) {
-        double mn = 1000000;
-        int u = 0;
-        for (int j = 0; j < n; ++j) {
-            if (keys[j] < mn && !in_set[j]) {
-                mn = keys[j];
-                u = j;
-            }
-        }
-        in_set[u] = true;
-        ans += keys[u];
-        for (int j = 0; j < n; ++j) {
-            if (!in_set[j]) {
-                double d = distance(points[u], points[j]);
-                if (d < keys[j]) {
-                    keys[j] = d;
-                }
-            }
+    Output out;
+    StreetNormalizer normalizer;
+    if (!streets_path.empty()) {
+        std::ifstream words (streets_path);
+        if (!words) {
+            out << "error loading " << streets_path << '\n';
+            out.flush();
+            exit(1);
         }
+        normalizer = StreetNormalizer::load(words);
     }
-    return ans;
-}
-
-std::unordered_map<std::string, std::pair<std::string, double>> task2(const pugi::xml_node& dataset) {
-    static const std::regex coord_split_rgx (",");
-    std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::pair<double, double>>>> map;
-    for (pugi::xml_node station = dataset.first_child(); station; station = station.next_sibling()) {
-        std::string type = station.child_value("type_of_vehicle");
-        std::string full_routes_string = station.child_value("routes");
-        std::vector<std::string> routes = get_routes(full_routes_string);
-        std::string coordinates_string = station.child_value("coordinates");
-        std::vector coords_strings = split(coordinates_string, coord_split_rgx, false);
-        std::pair<double, double> coords = std::make_pair(std::stod(coords_strings[0]), std::stod(coords_strings[1]));
+    Profiler profiler (profile || !profile_json.empty());
+    std::unique_ptr<Profiler::Phase> load = std::make_unique<Profiler::Phase>(profiler, "load");
 
-        if (!map.count(type)) {
-            map[type] = std::unordered_map<std::string, std::vector<std::pair<double, double>>> ();
-        }
-        for (const std::string& route : routes) {
-            if (!map[type].count(route)) {
-                map[type][route] = std::vector<std::pair<double, double>> ();
-            }
-            map[type][route].push_back(coords);
-        }
+    Dictionary dictionary;
+    RouteCounts route_counts (dictionary);
+    RoutePoints route_points (dictionary);
+    StreetCounts street_counts (dictionary, normalizer);
+    RouteMetrics route_metrics (route_points);
+    IncrementalTasks incremental (dictionary, default_threads(), normalizer);
+    JourneyPlanner planner;
+    StopClusters clusters (dictionary, cluster_meters);
+    Scanner scanner (dictionary);
+    // With --cluster the tasks see one station per cluster, replayed after the scan and the
+    // deltas; with deltas the feed is merged in the incremental tables first, so that delta
+    // stations are clustered too, and the tasks are then counted on the clusters.
+    Scanner clustered (dictionary);
+    Scanner& tasks = cluster_meters > 0 ? clustered : scanner;
+    bool use_incremental = !deltas.empty() && cluster_meters <= 0;
+    if (!use_incremental) {
+        tasks.add(route_counts).add(route_points).add(street_counts);
     }
-    std::unordered_map<std::string, std::pair<std::string, double>> ans;
-    for (const auto& [type, routes] : map) {
-        auto [route, points] = *std::max_element(routes.begin(), routes.end(), [](const auto& p1, const auto& p2) {
-            const std::vector<std::pair<double, double>>& points1 = p1.second;
-            const std::vector<std::pair<double, double>>& points2 = p2.second;
-            return mst_weight(points1) < mst_weight(points2);
-        });
-        ans[type] = std::make_pair(route, mst_weight(points));
+    if (!deltas.empty()) {
+        scanner.add(incremental);
+    } else if (cluster_meters > 0) {
+        scanner.add(clusters);
+    }
+    if (!journeys.empty()) {
+        scanner.add(planner);
     }
-    return ans;
-}
 
-std::pair<std::string, int> task3(const pugi::xml_node& dataset) {
-    static const std::vector<std::string> bad_words {
-        "ул\\.",
-        "пр\\.",
-        "улица",
-        "проспект",
-        "проезд",
-        "проспект",
-        "переулок",
-        "пер\\.",
-        "мост",
-        "аллея",
-        "ш\\.",
-        "шоссе",
-        "набережная",
-        "наб\\.",
-        "реки",
-        "р\\.",
-        "пл\\.",
-        "площадь",
-        "бульвар",
-        "бул\\.",
-        "дорога",
-        "дор\\.",
-        "канала"
-    };
-    static const std::regex location_split_rgx ("\\s*,\\s*");
-    static const std::regex word_split_rgx ("\\s+|"+join(bad_words,"|"));
-//    static const std::regex word_split_rgx ("\\s+");
-    static const std::regex two_lines_rgx("(\\d+)-(\\d+)-я линии(?: В\\.О\\.)?");
-    std::unordered_map<std::string, int> map;
-    for (pugi::xml_node station = dataset.first_child(); station; station = station.next_sibling()) {
-        std::string location = station.child_value("location");
-        std::vector<std::string> full_streets = split(location, location_split_rgx, false);
-        for (const std::string& full_street : full_streets) {
-            std::smatch smatch;
-            std::string short_street;
-            if (full_street.empty()) {
+    // The MST weights of data.xml kept with the snapshot stand in for every line that no
+    // delta touches; clustered tasks have point sets of their own.
+    auto seed_mst = [&](const std::vector<LineWeight>& weights) {
+        for (const LineWeight& weight : weights) {
+            int line = dictionary.find_line(weight.type, weight.route);
+            if (line < 0 || cluster_meters > 0) {
                 continue;
             }
-            else if (std::regex_match(full_street, smatch, two_lines_rgx)) {
-                std::string first_line = smatch[1].str() + "-я линия";
-                if (!map.count(first_line)) {
-                    map[first_line] = 0;
-                }
-                map[first_line]++;
-                short_street = smatch[2].str() + "-я линия";
-            }
-            else {
-                std::vector<std::string> words = split(full_street, word_split_rgx, false);
-//                if (words.size() == 1) {
-//                    std::cout << full_street << std::endl;
-//                }
-                short_street = join(words, " ");
+            if (use_incremental) {
+                incremental.seed_mst(line, weight.mst);
+            } else {
+                route_metrics.seed_mst(line, weight.mst);
             }
-            if (!map.count(short_street)) {
-                map[short_street] = 0;
-//                std::cout << "'" << full_street << "' : '" << short_street << "'" << std::endl;
-            }
-            map[short_street]++;
         }
+    };
+
+    SourceStamp stamp = SourceStamp::of("data.xml");
+    Snapshot snapshot ("data.xml.snap", stamp);
+    if (snapshot) {
+        snapshot.run(scanner);
+        seed_mst(snapshot.line_weights());
+    } else {
+        ShardedStationReader reader ("data.xml");
+        if (!reader) {
+            out << "error loading file\n";
+            out.flush();
+            exit(1);
+        }
+        SnapshotWriter writer;
+        scanner.add(writer);
+        reader.run(scanner);
+        if (reader.truncated()) {
+            out << "error loading file\n";
+            out.flush();
+            exit(1);
+        }
+        writer.save("data.xml.snap", stamp);
+        seed_mst(writer.line_weights());
     }
-    return *std::max_element(map.begin(), map.end(), comp_by_value<std::string, int>);
-}
 
-std::string stations(int n) {
-    switch (n % 10) {
-        case 1:
-            return "остановка";
-        case 2:
-        case 3:
-        case 4:
-            return "остановки";
-        default:
-            return "остановок";
+    for (const std::string& delta : deltas) {
+        if (!incremental.apply_delta(delta)) {
+            out << "error loading " << delta << '\n';
+            out.flush();
+            exit(1);
+        }
     }
-}
+    if (cluster_meters > 0) {
+        if (!deltas.empty()) {
+            incremental.replay(clusters);
+        }
+        clusters.run(clustered);
+    }
+    load.reset();
 
-int main() {
-    std::setlocale(LC_ALL, "Russian");
-    SetConsoleOutputCP(1251);
-    SetConsoleCP(1251);
+    std::unordered_map<std::string_view, std::pair<std::string_view, int>> ans1;
+    {
+        Profiler::Phase phase (profiler, "task1");
+        out << "Task 1:\n";
+        ans1 = use_incremental ? incremental.task1() : route_counts.result();
+        for (const auto&[type, champ] : ans1) {
+            const auto&[route, n] = champ;
+            out << type << ": " << route << " (" << n << " " << stations(n) << ")\n";
+        }
+    }
 
-    pugi::xml_document doc;
-    pugi::xml_parse_result res = doc.load_file("data.xml");
+    out << '\n';
 
-    if (!res) {
-        std::cout << "error loading file" << std::endl;
-        exit(1);
+    {
+        Profiler::Phase phase (profiler, "task2");
+        out << "Task 2:\n";
+        std::unordered_map<std::string_view, std::pair<std::string_view, double>> ans2 = use_incremental ? incremental.task2() : route_metrics.longest_routes();
+        for (const auto& [type, champ] : ans2) {
+            const auto& [route, len] = champ;
+            out << type << ": " << route << " (" << len << " м.)\n";
+        }
     }
 
-    pugi::xml_node dataset = doc.child("dataset");
+    out << '\n';
 
-    std::cout << "Task 1:" << std::endl;
-    std::unordered_map<std::string, std::pair<std::string, int>> ans1 = task1(dataset);
-    for (const auto&[type, champ] : ans1) {
-        const auto&[route, n] = champ;
-        std::cout << type << ": " << route << " (" << n << " " << stations(n) << ")" << std::endl;
+    {
+        Profiler::Phase phase (profiler, "task3");
+        out << "Task 3\n";
+        std::pair<std::string_view, int> ans3 = use_incremental ? incremental.task3() : street_counts.result();
+        const auto&[street, n] = ans3;
+        out << street << " (" << n << " " << stations(n) << ")\n";
     }
 
-    std::cout << std::endl;
-
-    std::cout << "Task 2:" << std::endl;
-    std::unordered_map<std::string, std::pair<std::string, double>> ans2 = task2(dataset);
-    for (const auto& [type, champ] : ans2) {
-        const auto& [route, len] = champ;
-        std::cout << type << ": " << route << " (" << len << " м.)" << std::endl;
+    if (top > 0) {
+        Profiler::Phase phase (profiler, "top");
+        Rankings rankings (route_counts, route_metrics, street_counts);
+        for (const auto& [type, champ] : ans1) {
+            out << '\n' << type << ", top " << top << " by stops:\n";
+            for (const auto& [route, count] : use_incremental ? incremental.routes_by_stops(type, top) : rankings.routes_by_stops(type, top)) {
+                out << route << " (" << count << " " << stations(count) << ")\n";
+            }
+            out << '\n' << type << ", top " << top << " by length:\n";
+            for (const auto& [route, len] : use_incremental ? incremental.routes_by_length(type, top) : rankings.routes_by_length(type, top)) {
+                out << route << " (" << len << " м.)\n";
+            }
+        }
+        out << "\nStreets, top " << top << ":\n";
+        for (const auto& [name, count] : use_incremental ? incremental.streets(top) : rankings.streets(top)) {
+            out << name << " (" << count << " " << stations(count) << ")\n";
+        }
     }
 
-    std::cout << std::endl;
+    for (const auto& [from_number, to_number] : journeys) {
+        Profiler::Phase phase (profiler, "journey");
+        int from = planner.station(from_number);
+        int to = planner.station(to_number);
+        out << "\nJourney " << from_number << " -> " << to_number << ":\n";
+        if (from < 0 || to < 0) {
+            out << "no such station\n";
+            continue;
+        }
+        out << "fewest transfers: ";
+        print_journey(out, planner.fewest_transfers(from, to), planner, dictionary);
+        out << "shortest: ";
+        print_journey(out, planner.shortest(from, to), planner, dictionary);
+    }
 
-    std::cout << "Task 3" << std::endl;
-    std::pair<std::string, int> ans3 = task3(dataset);
-    const auto&[street, n] = ans3;
-    std::cout << street << " (" << n << " " << stations(n) << ")" << std::endl;
+    out.flush();
+    if (profile) {
+        profiler.write_text(std::cerr);
+    }
+    if (!profile_json.empty()) {
+        std::ofstream json (profile_json);
+        profiler.write_json(json);
+    }
 }
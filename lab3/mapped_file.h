@@ -0,0 +1,95 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Private copy-on-write mapping of a whole file: pages are read lazily and can be
+// modified in place without touching the file on disk.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+            if (mapping) {
+                data_ = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+            size_ = data_ ? std::size_t(size.QuadPart) : 0;
+        }
+        ok_ = size.QuadPart == 0 || data_;
+        CloseHandle(file);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) == 0) {
+            if (st.st_size > 0) {
+                void* data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    data_ = static_cast<char*>(data);
+                    size_ = st.st_size;
+                }
+            }
+            ok_ = st.st_size == 0 || data_;
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_) {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(data_, size_);
+#endif
+        }
+    }
+
+    explicit operator bool() const {
+        return ok_;
+    }
+
+    char* data() const {
+        return data_;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+private:
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool ok_ = false;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <io.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+// UTF-8 text collected in memory and written with a single call on flush() or destruction.
+// Numbers are formatted with to_chars, so the output does not depend on the C or C++ locale;
+// doubles look like the default ostream format (6 significant digits). On a Windows console
+// the text goes through WriteConsoleW, so no console code page has to be set.
+class Output {
+public:
+    explicit Output(std::FILE* stream = stdout) : stream_(stream) {}
+
+    Output(const Output&) = delete;
+
+    Output& operator=(const Output&) = delete;
+
+    ~Output() {
+        flush();
+    }
+
+    Output& operator<<(std::string_view s) {
+        buffer_.append(s);
+        return *this;
+    }
+
+    Output& operator<<(char c) {
+        buffer_.push_back(c);
+        return *this;
+    }
+
+    template<class T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>, int> = 0>
+    Output& operator<<(T value) {
+        char digits[24];
+        buffer_.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+        return *this;
+    }
+
+    Output& operator<<(double value) {
+        char digits[32];
+        buffer_.append(digits, std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6).ptr);
+        return *this;
+    }
+
+    void flush() {
+        if (buffer_.empty()) {
+            return;
+        }
+#ifdef _WIN32
+        if (write_console()) {
+            buffer_.clear();
+            return;
+        }
+#endif
+        std::fwrite(buffer_.data(), 1, buffer_.size(), stream_);
+        std::fflush(stream_);
+        buffer_.clear();
+    }
+
+private:
+    std::FILE* stream_;
+    std::string buffer_;
+
+#ifdef _WIN32
+    bool write_console() {
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(stream_)));
+        DWORD mode;
+        if (handle == INVALID_HANDLE_VALUE || !GetConsoleMode(handle, &mode)) {
+            return false;
+        }
+        std::fflush(stream_);
+        int n = MultiByteToWideChar(CP_UTF8, 0, buffer_.data(), int(buffer_.size()), nullptr, 0);
+        std::wstring wide (n, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, buffer_.data(), int(buffer_.size()), wide.data(), n);
+        DWORD written;
+        return WriteConsoleW(handle, wide.data(), DWORD(wide.size()), &written, nullptr);
+    }
+#endif
+};
+
+#endif
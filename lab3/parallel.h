@@ -0,0 +1,52 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <exception>
+
+inline unsigned default_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs f(i) for i in [0, n) on a pool of threads that pull indices from a shared counter,
+// so long and short items balance out. f must only write to state owned by index i.
+template<class F>
+void parallel_for(int n, F f, unsigned threads = default_threads()) {
+    threads = std::min<unsigned>(threads, std::max(n, 1));
+    if (threads <= 1) {
+        for (int i = 0; i < n; ++i) {
+            f(i);
+        }
+        return;
+    }
+    std::atomic<int> next (0);
+    std::exception_ptr error;
+    std::atomic<bool> failed (false);
+    auto worker = [&]() {
+        for (int i; (i = next++) < n && !failed;) {
+            try {
+                f(i);
+            } catch (...) {
+                if (!failed.exchange(true)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
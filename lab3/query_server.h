@@ -0,0 +1,254 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "scan.h"
+#include "station_reader.h"
+#include "snapshot.h"
+#include "tasks.h"
+#include "route_metrics.h"
+#include "ranking.h"
+#include "station_index.h"
+#include "street_normalizer.h"
+
+// Tables for one version of the feed. Everything a query needs is computed by the
+// constructor, after which the model is only read, so any number of threads can share it.
+class FeedModel {
+public:
+    FeedModel(const std::string& path, const SourceStamp& stamp, const StreetNormalizer& normalizer = StreetNormalizer())
+            : stamp_(stamp)
+            , route_counts_(dictionary_)
+            , route_points_(dictionary_)
+            , street_counts_(dictionary_, normalizer)
+            , route_metrics_(route_points_) {
+        Scanner scanner (dictionary_);
+        scanner.add(route_counts_).add(route_points_).add(street_counts_).add(index_);
+        Snapshot snapshot (path + ".snap", stamp);
+        if (snapshot) {
+            snapshot.run(scanner);
+            for (const LineWeight& weight : snapshot.line_weights()) {
+                int line = dictionary_.find_line(weight.type, weight.route);
+                if (line >= 0) {
+                    route_metrics_.seed_mst(line, weight.mst);
+                }
+            }
+        } else {
+            ShardedStationReader reader (path);
+            if (!reader) {
+                return;
+            }
+            reader.run(scanner);
+            if (reader.truncated()) {
+                return;
+            }
+        }
+
+        index_.build();
+        Rankings rankings (route_counts_, route_metrics_, street_counts_);
+        by_stops_.resize(dictionary_.types.size());
+        by_length_.resize(dictionary_.types.size());
+        for (int type = 0; type < dictionary_.types.size(); ++type) {
+            by_stops_[type] = rankings.routes_by_stops(dictionary_.types.name(type));
+            by_length_[type] = rankings.routes_by_length(dictionary_.types.name(type));
+        }
+        streets_ = rankings.streets();
+        mst_.resize(dictionary_.lines.size());
+        for (int line = 0; line < dictionary_.lines.size(); ++line) {
+            mst_[line] = route_metrics_.mst_weight(line);
+        }
+        ok_ = true;
+    }
+
+    FeedModel(const FeedModel&) = delete;
+
+    FeedModel& operator=(const FeedModel&) = delete;
+
+    explicit operator bool() const {
+        return ok_;
+    }
+
+    const SourceStamp& stamp() const {
+        return stamp_;
+    }
+
+    const Dictionary& dictionary() const {
+        return dictionary_;
+    }
+
+    // Routes of a type by stop count or by length, best first; empty for an unknown type.
+    const std::vector<std::pair<std::string_view, int>>& routes_by_stops(std::string_view type) const {
+        int id = dictionary_.types.find(type);
+        return id < 0 ? none_by_stops_ : by_stops_[id];
+    }
+
+    const std::vector<std::pair<std::string_view, double>>& routes_by_length(std::string_view type) const {
+        int id = dictionary_.types.find(type);
+        return id < 0 ? none_by_length_ : by_length_[id];
+    }
+
+    const std::vector<std::pair<std::string_view, int>>& streets() const {
+        return streets_;
+    }
+
+    double mst_weight(int line) const {
+        return mst_[line];
+    }
+
+    const StationIndex& index() const {
+        return index_;
+    }
+
+private:
+    SourceStamp stamp_;
+    Dictionary dictionary_;
+    RouteCounts route_counts_;
+    RoutePoints route_points_;
+    StreetCounts street_counts_;
+    RouteMetrics route_metrics_;
+    StationIndex index_;
+    std::vector<std::vector<std::pair<std::string_view, int>>> by_stops_;
+    std::vector<std::vector<std::pair<std::string_view, double>>> by_length_;
+    std::vector<std::pair<std::string_view, int>> streets_;
+    std::vector<double> mst_;
+    std::vector<std::pair<std::string_view, int>> none_by_stops_;
+    std::vector<std::pair<std::string_view, double>> none_by_length_;
+    bool ok_ = false;
+};
+
+// Answers one-line queries against the current model of a feed file:
+//     top TYPE [K]                  K routes of TYPE with the most stops (default 10)
+//     longest TYPE [K]              K longest routes of TYPE
+//     mst [TYPE] ROUTE              length of a route, for every type that has it if TYPE
+//                                   is omitted; an unknown TYPE or ROUTE is an error
+//     street [K]                    K busiest streets (default 1)
+//     near LAT LON [K [TYPE]]       K stations closest to a point (default 1), of TYPE only
+//     within LAT LON METERS [TYPE]  stations within METERS of a point, closest first
+// Stations are listed as NUMBER TYPE METERS.
+// reload() swaps in a new model when the file has changed; queries running at that moment
+// finish on the model they started with.
+class QueryServer {
+public:
+    explicit QueryServer(std::string path, StreetNormalizer normalizer = StreetNormalizer())
+            : path_(std::move(path))
+            , normalizer_(std::move(normalizer)) {}
+
+    // Loads the feed if it changed since the current model was built. Returns false if it
+    // could not be loaded, e.g. while it is still being written; the old model stays.
+    bool reload() {
+        SourceStamp stamp = SourceStamp::of(path_);
+        std::shared_ptr<const FeedModel> current = model();
+        if (current && current->stamp() == stamp) {
+            return true;
+        }
+        auto next = std::make_shared<const FeedModel>(path_, stamp, normalizer_);
+        if (!*next || !(SourceStamp::of(path_) == stamp)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock (mutex_);
+        model_ = std::move(next);
+        return true;
+    }
+
+    std::shared_ptr<const FeedModel> model() const {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return model_;
+    }
+
+    // Zero or more answer lines, each ending with '\n'; errors start with "error:".
+    std::string answer(const std::string& query) const {
+        std::shared_ptr<const FeedModel> model = this->model();
+        if (!model) {
+            return "error: no data\n";
+        }
+        std::istringstream in (query);
+        std::vector<std::string> words;
+        for (std::string word; in >> word;) {
+            words.push_back(word);
+        }
+        std::ostringstream out;
+        if (words.empty()) {
+            return "";
+        } else if (words[0] == "top" && (words.size() == 2 || words.size() == 3)) {
+            print(out, model->routes_by_stops(words[1]), limit(words, 2, 10));
+        } else if (words[0] == "longest" && (words.size() == 2 || words.size() == 3)) {
+            print(out, model->routes_by_length(words[1]), limit(words, 2, 10));
+        } else if (words[0] == "street" && words.size() <= 2) {
+            print(out, model->streets(), limit(words, 1, 1));
+        } else if ((words[0] == "near" && words.size() >= 3 && words.size() <= 5)
+                || (words[0] == "within" && (words.size() == 4 || words.size() == 5))) {
+            std::pair<double, double> point;
+            double k_or_meters = 1;
+            if (!number(words[1], point.first) || !number(words[2], point.second)
+                    || (words.size() > 3 && (!number(words[3], k_or_meters) || k_or_meters < 0))) {
+                return "error: bad number\n";
+            }
+            int type = -1;
+            if (words.size() == 5) {
+                type = model->dictionary().types.find(words[4]);
+                if (type < 0) {
+                    return "error: unknown type " + words[4] + "\n";
+                }
+            }
+            const StationIndex& index = model->index();
+            std::vector<StationHit> hits = words[0] == "near" ? index.nearest(point, int(std::min<double>(k_or_meters, index.size())), type)
+                                                               : index.within(point, k_or_meters, type);
+            for (const StationHit& hit : hits) {
+                out << index.number(hit.station) << " " << model->dictionary().types.name(index.type(hit.station))
+                    << " " << hit.meters << "\n";
+            }
+        } else if (words[0] == "mst" && (words.size() == 2 || words.size() == 3)) {
+            const Dictionary& dictionary = model->dictionary();
+            int route = dictionary.routes.find(words.back());
+            int only_type = words.size() == 3 ? dictionary.types.find(words[1]) : -1;
+            if (words.size() == 3 && only_type < 0) {
+                return "error: unknown type " + words[1] + "\n";
+            }
+            if (route < 0) {
+                return "error: unknown route " + words.back() + "\n";
+            }
+            for (int type = 0; type < dictionary.types.size(); ++type) {
+                int line = dictionary.lines.find(type, route);
+                if (line >= 0 && (words.size() == 2 || type == only_type)) {
+                    out << dictionary.types.name(type) << " " << words.back() << " " << model->mst_weight(line) << "\n";
+                }
+            }
+        } else {
+            return "error: unknown query\n";
+        }
+        return out.str();
+    }
+
+private:
+    std::string path_;
+    StreetNormalizer normalizer_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const FeedModel> model_;
+
+    // The whole word as a finite number.
+    static bool number(const std::string& word, double& value) {
+        char* end = nullptr;
+        value = std::strtod(word.c_str(), &end);
+        return end != word.c_str() && *end == 0 && std::isfinite(value);
+    }
+
+    static std::size_t limit(const std::vector<std::string>& words, std::size_t i, int otherwise) {
+        return std::max(0, i < words.size() ? std::atoi(words[i].c_str()) : otherwise);
+    }
+
+    template<class T>
+    static void print(std::ostream& out, const std::vector<std::pair<std::string_view, T>>& ranking, std::size_t k) {
+        for (std::size_t i = 0; i < std::min(k, ranking.size()); ++i) {
+            out << ranking[i].first << " " << ranking[i].second << "\n";
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+#include "tasks.h"
+#include "route_metrics.h"
+
+// The k best of the candidates under better(a, b), best first. Small k keeps a bounded
+// heap (O(n log k)); otherwise the candidates are partially sorted in place.
+template<class Better>
+std::vector<int> top_k(std::vector<int> candidates, int k, Better better) {
+    std::size_t n = std::min<std::size_t>(std::max(k, 0), candidates.size());
+    if (n == 0) {
+        return std::vector<int>();
+    }
+    if (n*8 >= candidates.size()) {
+        std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(), better);
+        candidates.resize(n);
+        return candidates;
+    }
+    std::vector<int> heap;
+    heap.reserve(n + 1);
+    for (int candidate : candidates) {
+        if (heap.size() == n && !better(candidate, heap.front())) {
+            continue;
+        }
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end(), better);
+        if (heap.size() > n) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.pop_back();
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
+    return heap;
+}
+
+// Top-k and full listings over the aggregated tables. Ties are broken in first-seen
+// order, the same way as the single-winner task results.
+class Rankings {
+public:
+    static const int all = -1;
+
+    Rankings(const RouteCounts& counts, RouteMetrics& metrics, const StreetCounts& streets)
+            : counts_(counts)
+            , metrics_(metrics)
+            , streets_(streets) {
+        const Dictionary& dictionary = counts_.dictionary();
+        lines_of_type_.resize(dictionary.types.size());
+        for (int line = 0; line < dictionary.lines.size(); ++line) {
+            lines_of_type_[dictionary.line_type(line)].push_back(line);
+        }
+    }
+
+    std::vector<std::pair<std::string_view, int>> routes_by_stops(std::string_view type, int k = all) const {
+        std::vector<std::pair<std::string_view, int>> ans;
+        for (int line : top_k(lines(type), limit(k), [&](int l1, int l2) {
+            return counts_.count(l1) > counts_.count(l2) || (counts_.count(l1) == counts_.count(l2) && l1 < l2);
+        })) {
+            ans.emplace_back(route(line), counts_.count(line));
+        }
+        return ans;
+    }
+
+    std::vector<std::pair<std::string_view, double>> routes_by_length(std::string_view type, int k = all) {
+        metrics_.compute_all();
+        std::vector<std::pair<std::string_view, double>> ans;
+        for (int line : top_k(lines(type), limit(k), [&](int l1, int l2) {
+            double w1 = metrics_.mst_weight(l1);
+            double w2 = metrics_.mst_weight(l2);
+            return w1 > w2 || (w1 == w2 && l1 < l2);
+        })) {
+            ans.emplace_back(route(line), metrics_.mst_weight(line));
+        }
+        return ans;
+    }
+
+    std::vector<std::pair<std::string_view, int>> streets(int k = all) const {
+        std::vector<int> candidates (streets_.n_streets());
+        std::iota(candidates.begin(), candidates.end(), 0);
+        std::vector<std::pair<std::string_view, int>> ans;
+        for (int street : top_k(std::move(candidates), limit(k), [&](int s1, int s2) {
+            return streets_.count(s1) > streets_.count(s2) || (streets_.count(s1) == streets_.count(s2) && s1 < s2);
+        })) {
+            ans.emplace_back(streets_.name(street), streets_.count(street));
+        }
+        return ans;
+    }
+
+private:
+    const RouteCounts& counts_;
+    RouteMetrics& metrics_;
+    const StreetCounts& streets_;
+    std::vector<std::vector<int>> lines_of_type_;
+
+    static int limit(int k) {
+        return k < 0 ? std::numeric_limits<int>::max() : k;
+    }
+
+    std::vector<int> lines(std::string_view type) const {
+        int id = counts_.dictionary().types.find(type);
+        return id < 0 ? std::vector<int>() : lines_of_type_[id];
+    }
+
+    std::string_view route(int line) const {
+        const Dictionary& dictionary = counts_.dictionary();
+        return dictionary.routes.name(dictionary.line_route(line));
+    }
+};
+
+#endif
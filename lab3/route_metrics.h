@@ -0,0 +1,82 @@
+#ifndef ROUTE_METRICS_H
+#define ROUTE_METRICS_H
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "tasks.h"
+#include "geo_mst.h"
+#include "parallel.h"
+
+// Per-line metrics over the grouped points, each computed at most once.
+class RouteMetrics {
+public:
+    explicit RouteMetrics(const RoutePoints& points, unsigned threads = default_threads())
+            : points_(points)
+            , threads_(threads) {}
+
+    double mst_weight(int line) {
+        if (line >= int(mst_.size())) {
+            mst_.resize(line + 1, NAN);
+        }
+        if (std::isnan(mst_[line])) {
+            mst_[line] = geo_mst_weight(points_.points(line));
+        }
+        return mst_[line];
+    }
+
+    // Takes a weight computed elsewhere over the same points, e.g. stored in a snapshot.
+    void seed_mst(int line, double weight) {
+        if (line >= int(mst_.size())) {
+            mst_.resize(line + 1, NAN);
+        }
+        mst_[line] = weight;
+    }
+
+    // Fills the cache for every line at once, largest lines first across the thread pool.
+    // Each weight is written to its own slot, so the outcome does not depend on scheduling.
+    void compute_all() {
+        mst_.resize(points_.n_lines(), NAN);
+        std::vector<int> jobs;
+        for (int line = 0; line < points_.n_lines(); ++line) {
+            if (std::isnan(mst_[line])) {
+                jobs.push_back(line);
+            }
+        }
+        std::stable_sort(jobs.begin(), jobs.end(), [&](int l1, int l2) {
+            return points_.points(l1).size() > points_.points(l2).size();
+        });
+        parallel_for(jobs.size(), [&](int i) {
+            mst_[jobs[i]] = geo_mst_weight(points_.points(jobs[i]));
+        }, threads_);
+    }
+
+    std::unordered_map<std::string_view, std::pair<std::string_view, double>> longest_routes() {
+        compute_all();
+        const Dictionary& dictionary = points_.dictionary();
+        std::vector<int> best (dictionary.types.size(), -1);
+        for (int line = 0; line < points_.n_lines(); ++line) {
+            int& champ = best[dictionary.line_type(line)];
+            if (champ < 0 || mst_[line] > mst_[champ]) {
+                champ = line;
+            }
+        }
+        std::unordered_map<std::string_view, std::pair<std::string_view, double>> ans;
+        for (int type = 0; type < int(best.size()); ++type) {
+            if (best[type] >= 0) {
+                ans[dictionary.types.name(type)] = std::make_pair(dictionary.routes.name(dictionary.line_route(best[type])), mst_[best[type]]);
+            }
+        }
+        return ans;
+    }
+
+private:
+    const RoutePoints& points_;
+    unsigned threads_;
+    std::vector<double> mst_;
+};
+
+#endif
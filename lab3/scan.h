@@ -0,0 +1,124 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tokenizer.h"
+#include "interner.h"
+
+// Fields are views into the source buffer. type and routes stay valid for the
+// lifetime of the source, streets (the comma-separated parts of <location>)
+// only for the duration of consume(). The ids are filled in by the Scanner.
+struct Station {
+    int number = 0;
+    std::string_view type;
+    std::vector<std::string_view> routes;
+    std::pair<double, double> coords;
+    std::vector<std::string_view> streets;
+
+    int type_id = -1;
+    std::vector<int> lines;
+    std::vector<int> street_ids;
+};
+
+class Aggregator {
+public:
+    virtual ~Aggregator() = default;
+
+    virtual void consume(const Station& station) = 0;
+};
+
+// Route list up to the first '.', e.g. "29,45.К-10" -> {"29", "45"}.
+inline void get_routes(std::string_view full_routes_string, std::vector<std::string_view>& routes) {
+    routes.clear();
+    for_each_token(first_token(full_routes_string, '.'), ',', [&](std::string_view route) {
+        routes.push_back(route);
+    });
+}
+
+inline void get_streets(std::string_view location, std::vector<std::string_view>& streets) {
+    streets.clear();
+    for_each_list_item(location, [&](std::string_view street) {
+        streets.push_back(street);
+    });
+}
+
+inline std::pair<double, double> get_coords(std::string_view coordinates_string) {
+    return parse_coords(coordinates_string);
+}
+
+// Ids shared by every aggregator of a scan: vehicle types, route names, (type, route)
+// lines and raw street names.
+class Dictionary {
+public:
+    Interner types;
+    Interner routes;
+    Interner streets;
+    PairInterner lines;
+
+    int line_type(int line) const {
+        return lines.first(line);
+    }
+
+    int line_route(int line) const {
+        return lines.second(line);
+    }
+
+    // Id of the line of a type and route, or -1.
+    int find_line(std::string_view type, std::string_view route) const {
+        int type_id = types.find(type);
+        int route_id = routes.find(route);
+        return type_id < 0 || route_id < 0 ? -1 : lines.find(type_id, route_id);
+    }
+
+    void resolve(Station& station) {
+        station.type_id = types.intern(station.type);
+        station.lines.clear();
+        for (std::string_view route : station.routes) {
+            station.lines.push_back(lines.intern(station.type_id, routes.intern(route)));
+        }
+        station.street_ids.clear();
+        for (std::string_view street : station.streets) {
+            station.street_ids.push_back(streets.intern(street));
+        }
+    }
+};
+
+// Hands each decoded station to all registered aggregators, so adding a report does not
+// add another pass over the dataset. Strings are resolved to ids once here; aggregators
+// work on the ids.
+class Scanner : public Aggregator {
+public:
+    explicit Scanner(Dictionary& dictionary) : dictionary_(dictionary) {}
+
+    Scanner& add(Aggregator& aggregator) {
+        aggregators_.push_back(&aggregator);
+        return *this;
+    }
+
+    Dictionary& dictionary() {
+        return dictionary_;
+    }
+
+    void consume(const Station& station) override {
+        station_ = station;
+        dictionary_.resolve(station_);
+        dispatch(station_);
+    }
+
+    // Forwards a station whose ids already come from this scanner's dictionary.
+    void dispatch(const Station& station) {
+        for (Aggregator* aggregator : aggregators_) {
+            aggregator->consume(station);
+        }
+    }
+
+private:
+    Dictionary& dictionary_;
+    Station station_;
+    std::vector<Aggregator*> aggregators_;
+};
+
+#endif
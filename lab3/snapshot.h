@@ -0,0 +1,340 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "scan.h"
+#include "mapped_file.h"
+#include "interner.h"
+#include "geo_mst.h"
+#include "parallel.h"
+
+// Size and modification time of the XML a snapshot was built from.
+struct SourceStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+
+    static SourceStamp of(const std::string& path) {
+        std::error_code ec;
+        SourceStamp stamp;
+        stamp.size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return SourceStamp();
+        }
+        stamp.mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return stamp;
+    }
+
+    friend bool operator==(const SourceStamp& s1, const SourceStamp& s2) {
+        return s1.size == s2.size && s1.mtime == s2.mtime;
+    }
+};
+
+// MST weight of one (type, route) line of the source, as geo_mst_weight gives it over the
+// line's stops in feed order.
+struct LineWeight {
+    std::string_view type;
+    std::string_view route;
+    double mst;
+};
+
+// Columnar snapshot layout: header, then 8-byte aligned columns
+// number[n] type[n] lat[n] lon[n] route_begin[n+1] routes[r] street_begin[n+1] streets[s]
+// string_begin[m+1] string_bytes[b] line_type[l] line_route[l] line_mst[l]. Types, routes
+// and streets are ids into the string table.
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint32_t n_stations;
+    std::uint32_t n_route_refs;
+    std::uint32_t n_street_refs;
+    std::uint32_t n_strings;
+    std::uint64_t n_string_bytes;
+    std::uint32_t n_lines;
+    std::uint32_t mst_kernel;
+};
+
+static const char snapshot_magic[8] = {'L', 'A', 'B', '3', 'S', 'N', 'A', 'P'};
+static const std::uint32_t snapshot_version = 2;
+static const std::uint32_t snapshot_byte_order = 0x01020304;
+
+// The distance kernels round differently with AVX2 or FMA, so stored MST weights are only
+// reused by a build with the same ones.
+static const std::uint32_t snapshot_mst_kernel = 0
+#ifdef __AVX2__
+        | 1
+#endif
+#ifdef __FMA__
+        | 2
+#endif
+        ;
+
+inline std::size_t snapshot_align(std::size_t offset) {
+    return (offset + 7) & ~std::size_t(7);
+}
+
+// Collects decoded stations into columns while they stream past, then writes them out
+// together with the MST weight of every line.
+class SnapshotWriter : public Aggregator {
+public:
+    explicit SnapshotWriter(unsigned threads = default_threads()) : threads_(threads) {}
+
+    void consume(const Station& station) override {
+        number_.push_back(station.number);
+        type_.push_back(intern(station.type));
+        lat_.push_back(station.coords.first);
+        lon_.push_back(station.coords.second);
+        for (std::string_view route : station.routes) {
+            routes_.push_back(intern(route));
+            int line = lines_.intern(type_.back(), routes_.back());
+            if (line >= int(points_.size())) {
+                points_.resize(line + 1);
+            }
+            points_[line].push_back(station.coords);
+        }
+        route_begin_.push_back(routes_.size());
+        for (std::string_view street : station.streets) {
+            streets_.push_back(intern(street));
+        }
+        street_begin_.push_back(streets_.size());
+    }
+
+    // Writes to a temporary file and renames it over path, so readers never see a partial snapshot.
+    bool save(const std::string& path, const SourceStamp& stamp) {
+        compute_mst();
+        std::vector<std::int32_t> line_type (lines_.size());
+        std::vector<std::int32_t> line_route (lines_.size());
+        for (int line = 0; line < lines_.size(); ++line) {
+            line_type[line] = lines_.first(line);
+            line_route[line] = lines_.second(line);
+        }
+
+        SnapshotHeader header {};
+        std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+        header.version = snapshot_version;
+        header.byte_order = snapshot_byte_order;
+        header.source_size = stamp.size;
+        header.source_mtime = stamp.mtime;
+        header.n_stations = number_.size();
+        header.n_route_refs = routes_.size();
+        header.n_street_refs = streets_.size();
+        header.n_strings = strings_.size();
+        header.n_string_bytes = strings_.bytes().size();
+        header.n_lines = lines_.size();
+        header.mst_kernel = snapshot_mst_kernel;
+
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out (tmp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            std::size_t offset = 0;
+            auto write = [&](const void* data, std::size_t size) {
+                static const char zeros[8] = {};
+                out.write(zeros, snapshot_align(offset) - offset);
+                offset = snapshot_align(offset);
+                out.write(static_cast<const char*>(data), size);
+                offset += size;
+            };
+            write(&header, sizeof(header));
+            write(number_.data(), number_.size()*sizeof(std::int32_t));
+            write(type_.data(), type_.size()*sizeof(std::int32_t));
+            write(lat_.data(), lat_.size()*sizeof(double));
+            write(lon_.data(), lon_.size()*sizeof(double));
+            write(route_begin_.data(), route_begin_.size()*sizeof(std::uint32_t));
+            write(routes_.data(), routes_.size()*sizeof(std::int32_t));
+            write(street_begin_.data(), street_begin_.size()*sizeof(std::uint32_t));
+            write(streets_.data(), streets_.size()*sizeof(std::int32_t));
+            write(strings_.offsets().data(), strings_.offsets().size()*sizeof(std::uint64_t));
+            write(strings_.bytes().data(), strings_.bytes().size());
+            write(line_type.data(), line_type.size()*sizeof(std::int32_t));
+            write(line_route.data(), line_route.size()*sizeof(std::int32_t));
+            write(mst_.data(), mst_.size()*sizeof(double));
+            if (!out) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        return !ec;
+    }
+
+    // The weights written by save(), valid while the writer lives.
+    std::vector<LineWeight> line_weights() {
+        compute_mst();
+        std::vector<LineWeight> ans;
+        for (int line = 0; line < lines_.size(); ++line) {
+            ans.push_back(LineWeight {strings_.name(lines_.first(line)), strings_.name(lines_.second(line)), mst_[line]});
+        }
+        return ans;
+    }
+
+private:
+    unsigned threads_;
+    std::vector<std::int32_t> number_;
+    std::vector<std::int32_t> type_;
+    std::vector<double> lat_;
+    std::vector<double> lon_;
+    std::vector<std::uint32_t> route_begin_ {0};
+    std::vector<std::int32_t> routes_;
+    std::vector<std::uint32_t> street_begin_ {0};
+    std::vector<std::int32_t> streets_;
+    Interner strings_;
+    PairInterner lines_;
+    std::vector<std::vector<std::pair<double, double>>> points_;
+    std::vector<double> mst_;
+
+    std::int32_t intern(std::string_view s) {
+        return strings_.intern(s);
+    }
+
+    // Once, after the last station; the points are not needed after that.
+    void compute_mst() {
+        if (int(mst_.size()) == lines_.size()) {
+            return;
+        }
+        mst_.assign(lines_.size(), 0);
+        parallel_for(lines_.size(), [&](int line) {
+            mst_[line] = geo_mst_weight(points_[line]);
+        }, threads_);
+        points_ = {};
+    }
+};
+
+// Read side: maps a snapshot and replays its stations. It is only valid if it was
+// built from a source with the same size and mtime; views point into the mapping.
+class Snapshot {
+public:
+    Snapshot(const std::string& path, const SourceStamp& stamp) : file_(path) {
+        if (!file_ || file_.size() < sizeof(SnapshotHeader)) {
+            return;
+        }
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, snapshot_magic, sizeof(header_.magic)) != 0
+                || header_.version != snapshot_version
+                || header_.byte_order != snapshot_byte_order
+                || !(SourceStamp {header_.source_size, header_.source_mtime} == stamp)) {
+            return;
+        }
+        std::size_t n = header_.n_stations;
+        std::size_t offset = sizeof(header_);
+        number_ = column<std::int32_t>(offset, n);
+        type_ = column<std::int32_t>(offset, n);
+        lat_ = column<double>(offset, n);
+        lon_ = column<double>(offset, n);
+        route_begin_ = column<std::uint32_t>(offset, n + 1);
+        routes_ = column<std::int32_t>(offset, header_.n_route_refs);
+        street_begin_ = column<std::uint32_t>(offset, n + 1);
+        streets_ = column<std::int32_t>(offset, header_.n_street_refs);
+        string_begin_ = column<std::uint64_t>(offset, std::size_t(header_.n_strings) + 1);
+        string_bytes_ = column<char>(offset, header_.n_string_bytes);
+        line_type_ = column<std::int32_t>(offset, header_.n_lines);
+        line_route_ = column<std::int32_t>(offset, header_.n_lines);
+        line_mst_ = column<double>(offset, header_.n_lines);
+        valid_ = offset <= file_.size() && consistent();
+    }
+
+    explicit operator bool() const {
+        return valid_;
+    }
+
+    int size() const {
+        return header_.n_stations;
+    }
+
+    std::string_view string(std::int32_t id) const {
+        return std::string_view(string_bytes_ + string_begin_[id], string_begin_[id + 1] - string_begin_[id]);
+    }
+
+    void run(Aggregator& aggregator) const {
+        Station station;
+        for (int i = 0; i < size(); ++i) {
+            station.number = number_[i];
+            station.type = string(type_[i]);
+            station.coords = std::make_pair(lat_[i], lon_[i]);
+            station.routes.clear();
+            for (std::uint32_t j = route_begin_[i]; j < route_begin_[i + 1]; ++j) {
+                station.routes.push_back(string(routes_[j]));
+            }
+            station.streets.clear();
+            for (std::uint32_t j = street_begin_[i]; j < street_begin_[i + 1]; ++j) {
+                station.streets.push_back(string(streets_[j]));
+            }
+            aggregator.consume(station);
+        }
+    }
+
+    // Stored MST weights, or none if they came from a build with other distance kernels.
+    std::vector<LineWeight> line_weights() const {
+        std::vector<LineWeight> ans;
+        for (std::uint32_t line = 0; header_.mst_kernel == snapshot_mst_kernel && line < header_.n_lines; ++line) {
+            ans.push_back(LineWeight {string(line_type_[line]), string(line_route_[line]), line_mst_[line]});
+        }
+        return ans;
+    }
+
+private:
+    MappedFile file_;
+    SnapshotHeader header_ {};
+    bool valid_ = false;
+    const std::int32_t* number_ = nullptr;
+    const std::int32_t* type_ = nullptr;
+    const double* lat_ = nullptr;
+    const double* lon_ = nullptr;
+    const std::uint32_t* route_begin_ = nullptr;
+    const std::int32_t* routes_ = nullptr;
+    const std::uint32_t* street_begin_ = nullptr;
+    const std::int32_t* streets_ = nullptr;
+    const std::uint64_t* string_begin_ = nullptr;
+    const char* string_bytes_ = nullptr;
+    const std::int32_t* line_type_ = nullptr;
+    const std::int32_t* line_route_ = nullptr;
+    const double* line_mst_ = nullptr;
+
+    template<class T>
+    const T* column(std::size_t& offset, std::size_t count) {
+        offset = snapshot_align(offset);
+        if (offset > file_.size() || count > (file_.size() - offset)/sizeof(T)) {
+            offset = file_.size() + 1;
+            return nullptr;
+        }
+        const T* data = reinterpret_cast<const T*>(file_.data() + offset);
+        offset += count*sizeof(T);
+        return data;
+    }
+
+    // The stamp only says which source the file was built from; a damaged or truncated
+    // file can still carry the right one. Every id and offset that run() follows is
+    // checked once here, so a bad file is rejected instead of read out of bounds.
+    bool consistent() const {
+        std::size_t n = header_.n_stations;
+        std::int64_t n_strings = header_.n_strings;
+        auto ids_ok = [&](const std::int32_t* ids, std::size_t count) {
+            return std::all_of(ids, ids + count, [&](std::int32_t id) {
+                return id >= 0 && id < n_strings;
+            });
+        };
+        auto offsets_ok = [](const auto* begin, std::size_t count, std::uint64_t total) {
+            return begin[0] == 0 && begin[count] == total && std::is_sorted(begin, begin + count + 1);
+        };
+        return ids_ok(type_, n)
+            && offsets_ok(route_begin_, n, header_.n_route_refs) && ids_ok(routes_, header_.n_route_refs)
+            && offsets_ok(street_begin_, n, header_.n_street_refs) && ids_ok(streets_, header_.n_street_refs)
+            && offsets_ok(string_begin_, header_.n_strings, header_.n_string_bytes)
+            && ids_ok(line_type_, header_.n_lines) && ids_ok(line_route_, header_.n_lines);
+    }
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef STATION_COORDS_H
+#define STATION_COORDS_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+static const double earth_radius = 6371000;
+
+// Station positions in structure-of-arrays form as unit vectors (x, y, z = sin(lat)), with
+// the trigonometry done once per station.
+class StationCoords {
+public:
+    StationCoords() = default;
+
+    explicit StationCoords(const std::vector<std::pair<double, double>>& points) {
+        reserve(points.size());
+        for (const std::pair<double, double>& p : points) {
+            push_back(p);
+        }
+    }
+
+    void reserve(std::size_t n) {
+        x_.reserve(n);
+        y_.reserve(n);
+        z_.reserve(n);
+    }
+
+    void push_back(const std::pair<double, double>& p) {
+        double lat = p.first*M_PI/180;
+        double lon = p.second*M_PI/180;
+        double cos_lat = std::cos(lat);
+        x_.push_back(cos_lat*std::cos(lon));
+        y_.push_back(cos_lat*std::sin(lon));
+        z_.push_back(std::sin(lat));
+    }
+
+    // Moves the last station into slot i and drops it, so removal keeps the columns packed.
+    void remove_swap(int i) {
+        x_[i] = x_.back();
+        y_[i] = y_.back();
+        z_[i] = z_.back();
+        x_.pop_back();
+        y_.pop_back();
+        z_.pop_back();
+    }
+
+    int size() const {
+        return x_.size();
+    }
+
+    const double* x() const {
+        return x_.data();
+    }
+
+    const double* y() const {
+        return y_.data();
+    }
+
+    const double* z() const {
+        return z_.data();
+    }
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+};
+
+// Squared chord between unit vectors. For the haversine h of the same pair chord2 = 4h,
+// so chord2_to_meters gives the great-circle distance without the cancellation in 1 - cos.
+inline double chord2_to_meters(double chord2) {
+    return 2*earth_radius*std::asin(std::min(1.0, std::sqrt(chord2)/2));
+}
+
+inline double meters_to_chord2(double meters) {
+    double half = std::sin(std::min(meters / (2*earth_radius), M_PI/2));
+    return 4*half*half;
+}
+
+// out[j] = squared chord from (qx, qy, qz) to point j, for j in [0, n).
+inline void chord2_kernel(double qx, double qy, double qz, const double* x, const double* y, const double* z, int n, double* out) {
+    int j = 0;
+#ifdef __AVX2__
+    __m256d vx = _mm256_set1_pd(qx);
+    __m256d vy = _mm256_set1_pd(qy);
+    __m256d vz = _mm256_set1_pd(qz);
+    for (; j + 4 <= n; j += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), vx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), vy);
+        __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + j), vz);
+        __m256d d2 = _mm256_mul_pd(dx, dx);
+        d2 = _mm256_add_pd(d2, _mm256_mul_pd(dy, dy));
+        d2 = _mm256_add_pd(d2, _mm256_mul_pd(dz, dz));
+        _mm256_storeu_pd(out + j, d2);
+    }
+#endif
+    for (; j < n; ++j) {
+        double dx = x[j] - qx;
+        double dy = y[j] - qy;
+        double dz = z[j] - qz;
+        out[j] = dx*dx + dy*dy + dz*dz;
+    }
+}
+
+// keys[j] = min(keys[j], squared chord from (qx, qy, qz) to point j): the Prim relaxation step.
+inline void relax_kernel(double qx, double qy, double qz, const double* x, const double* y, const double* z, int n, double* keys) {
+    int j = 0;
+#ifdef __AVX2__
+    __m256d vx = _mm256_set1_pd(qx);
+    __m256d vy = _mm256_set1_pd(qy);
+    __m256d vz = _mm256_set1_pd(qz);
+    for (; j + 4 <= n; j += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), vx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), vy);
+        __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + j), vz);
+        __m256d d2 = _mm256_mul_pd(dx, dx);
+        d2 = _mm256_add_pd(d2, _mm256_mul_pd(dy, dy));
+        d2 = _mm256_add_pd(d2, _mm256_mul_pd(dz, dz));
+        _mm256_storeu_pd(keys + j, _mm256_min_pd(d2, _mm256_loadu_pd(keys + j)));
+    }
+#endif
+    for (; j < n; ++j) {
+        double dx = x[j] - qx;
+        double dy = y[j] - qy;
+        double dz = z[j] - qz;
+        keys[j] = std::min(keys[j], dx*dx + dy*dy + dz*dz);
+    }
+}
+
+// Great-circle distances in metres from station i to every station.
+inline void distances_from(const StationCoords& coords, int i, double* out) {
+    chord2_kernel(coords.x()[i], coords.y()[i], coords.z()[i], coords.x(), coords.y(), coords.z(), coords.size(), out);
+    for (int j = 0; j < coords.size(); ++j) {
+        out[j] = chord2_to_meters(out[j]);
+    }
+}
+
+// Dense Prim on squared chords. Takes the coordinates by value and uses them as the working
+// set: vertices still outside the tree stay packed at the front, so both the argmin and the
+// relaxation run over contiguous data.
+inline double prim_mst_weight(StationCoords coords) {
+    int n = coords.size();
+    std::vector<double> keys (n, std::numeric_limits<double>::infinity());
+    if (n > 0) {
+        keys[0] = 0;
+    }
+    double ans = 0;
+    for (int m = n; m > 0; --m) {
+        int u = 0;
+        for (int j = 1; j < m; ++j) {
+            if (keys[j] < keys[u]) {
+                u = j;
+            }
+        }
+        ans += chord2_to_meters(keys[u]);
+        double ux = coords.x()[u];
+        double uy = coords.y()[u];
+        double uz = coords.z()[u];
+        coords.remove_swap(u);
+        keys[u] = keys[m - 1];
+        relax_kernel(ux, uy, uz, coords.x(), coords.y(), coords.z(), m - 1, keys.data());
+    }
+    return ans;
+}
+
+#endif
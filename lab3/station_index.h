@@ -0,0 +1,101 @@
+#ifndef STATION_INDEX_H
+#define STATION_INDEX_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "scan.h"
+#include "geo.h"
+#include "kdtree.h"
+#include "station_coords.h"
+
+struct StationHit {
+    int station;
+    double meters;
+};
+
+struct TypeFilter {
+    const std::vector<int>& types;
+    int type;
+
+    bool operator()(int station) const {
+        return type < 0 || types[station] == type;
+    }
+};
+
+// k-d tree over all stations as unit vectors for nearest-stop and radius queries.
+// Stations are numbered in scan order; type filters take Dictionary type ids, -1 for any.
+// Queries are const, so threads can share a built index; build() after the last station.
+class StationIndex : public Aggregator {
+public:
+    void consume(const Station& station) override {
+        numbers_.push_back(station.number);
+        types_.push_back(station.type_id);
+        coords_.push_back(station.coords);
+        tree_.reset();
+    }
+
+    void build() {
+        std::vector<Vec3> units;
+        units.reserve(coords_.size());
+        for (const std::pair<double, double>& p : coords_) {
+            units.push_back(unit_vector(p));
+        }
+        tree_ = std::make_unique<KdTree>(std::move(units));
+    }
+
+    int size() const {
+        return coords_.size();
+    }
+
+    int number(int station) const {
+        return numbers_[station];
+    }
+
+    int type(int station) const {
+        return types_[station];
+    }
+
+    const std::pair<double, double>& coords(int station) const {
+        return coords_[station];
+    }
+
+    std::vector<StationHit> nearest(const std::pair<double, double>& point, int k, int type = -1) const {
+        std::vector<StationHit> ans;
+        if (!tree_) {
+            return ans;
+        }
+        for (auto [d2, station] : tree_->k_nearest(unit_vector(point), k, accept(type))) {
+            ans.push_back(StationHit {station, chord2_to_meters(d2)});
+        }
+        return ans;
+    }
+
+    // Hits ordered by distance.
+    std::vector<StationHit> within(const std::pair<double, double>& point, double meters, int type = -1) const {
+        std::vector<StationHit> ans;
+        if (!tree_) {
+            return ans;
+        }
+        tree_->within(unit_vector(point), meters_to_chord2(meters), accept(type), [&](int station, double d2) {
+            ans.push_back(StationHit {station, chord2_to_meters(d2)});
+        });
+        std::sort(ans.begin(), ans.end(), [](const StationHit& h1, const StationHit& h2) {
+            return h1.meters < h2.meters || (h1.meters == h2.meters && h1.station < h2.station);
+        });
+        return ans;
+    }
+
+private:
+    std::vector<int> numbers_;
+    std::vector<int> types_;
+    std::vector<std::pair<double, double>> coords_;
+    std::unique_ptr<KdTree> tree_;
+
+    TypeFilter accept(int type) const {
+        return TypeFilter {types_, type};
+    }
+};
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef STATION_READER_H
+#define STATION_READER_H
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include "scan.h"
+#include "xml_record.h"
+#include "mapped_file.h"
+#include "string_pool.h"
+#include "parallel.h"
+
+// Streams <transport_station> records out of the file one chunk at a time, so memory
+// stays bounded by the read buffer, the largest record and the distinct types and routes.
+class StationReader {
+public:
+    explicit StationReader(const std::string& path, std::size_t chunk_size = 1 << 16)
+            : in_(path, std::ios::binary)
+            , chunk_size_(chunk_size) {}
+
+    explicit operator bool() const {
+        return in_.is_open();
+    }
+
+    bool truncated() const {
+        return truncated_;
+    }
+
+    void run(Aggregator& aggregator) {
+        Station station;
+        while (fill()) {
+            char* begin = buffer_.data();
+            char* rest = for_each_record(begin, begin + buffer_.size(), [&](char* body, char* body_end) {
+                decode_station(body, body_end, station);
+                station.type = pool_.intern(station.type);
+                for (std::string_view& route : station.routes) {
+                    route = pool_.intern(route);
+                }
+                aggregator.consume(station);
+            });
+            if (rest == begin + buffer_.size()) {
+                // keep a tail that may hold the start of a split open tag
+                rest -= std::min(buffer_.size(), station_open_tag.size() - 1);
+            }
+            buffer_.erase(0, rest - begin);
+        }
+        truncated_ = buffer_.find(station_open_tag) != std::string::npos;
+    }
+
+private:
+    std::ifstream in_;
+    std::size_t chunk_size_;
+    std::string buffer_;
+    StringPool pool_;
+    bool truncated_ = false;
+
+    bool fill() {
+        std::size_t old_size = buffer_.size();
+        buffer_.resize(old_size + chunk_size_);
+        in_.read(buffer_.data() + old_size, chunk_size_);
+        buffer_.resize(old_size + in_.gcount());
+        return in_.gcount() > 0;
+    }
+};
+
+// Parses records in situ over a private mapping of the file; every field is a view
+// into the mapped pages, valid for the lifetime of the reader.
+class MappedStationReader {
+public:
+    explicit MappedStationReader(const std::string& path) : file_(path) {}
+
+    explicit operator bool() const {
+        return bool(file_);
+    }
+
+    bool truncated() const {
+        return truncated_;
+    }
+
+    void run(Aggregator& aggregator) {
+        Station station;
+        char* end = file_.data() + file_.size();
+        char* rest = for_each_record(file_.data(), end, [&](char* body, char* body_end) {
+            decode_station(body, body_end, station);
+            aggregator.consume(station);
+        });
+        truncated_ = rest != end;
+    }
+
+private:
+    MappedFile file_;
+    bool truncated_ = false;
+};
+
+// Parses the mapping on several threads. The file is cut into shards at record boundaries
+// and every shard decodes its records into shard-local id tables; the tables are then
+// merged into the scanner's dictionary shard by shard and replayed in file order, so ids
+// and reports come out exactly as from a sequential scan. A record must close before the
+// next one opens.
+class ShardedStationReader {
+public:
+    explicit ShardedStationReader(const std::string& path, unsigned threads = default_threads())
+            : file_(path)
+            , threads_(threads) {}
+
+    explicit operator bool() const {
+        return bool(file_);
+    }
+
+    bool truncated() const {
+        return truncated_;
+    }
+
+    void run(Scanner& scanner) {
+        std::vector<char*> bounds = shard_bounds();
+        std::vector<Shard> shards (bounds.size() - 1);
+        parallel_for(shards.size(), [&](int i) {
+            shards[i].parse(bounds[i], bounds[i + 1]);
+        }, threads_);
+        truncated_ = false;
+        for (Shard& shard : shards) {
+            truncated_ = truncated_ || shard.truncated;
+            shard.replay(scanner);
+            shard = Shard();
+        }
+    }
+
+private:
+    // Records of one shard with ids local to it; names are views into the mapping.
+    struct Shard {
+        Dictionary dictionary;
+        std::vector<std::string_view> types;
+        std::vector<std::string_view> routes;
+        std::vector<std::string_view> streets;
+        std::vector<int> number;
+        std::vector<std::pair<double, double>> coords;
+        std::vector<int> type;
+        std::vector<std::uint32_t> line_end;
+        std::vector<int> lines;
+        std::vector<std::uint32_t> street_end;
+        std::vector<int> street_ids;
+        bool truncated = false;
+
+        void parse(char* begin, char* end) {
+            Station station;
+            char* rest = for_each_record(begin, end, [&](char* body, char* body_end) {
+                decode_station(body, body_end, station);
+                dictionary.resolve(station);
+                remember(types, station.type_id, station.type);
+                for (std::size_t i = 0; i < station.lines.size(); ++i) {
+                    remember(routes, dictionary.line_route(station.lines[i]), station.routes[i]);
+                }
+                for (std::size_t i = 0; i < station.street_ids.size(); ++i) {
+                    remember(streets, station.street_ids[i], station.streets[i]);
+                }
+                number.push_back(station.number);
+                coords.push_back(station.coords);
+                type.push_back(station.type_id);
+                lines.insert(lines.end(), station.lines.begin(), station.lines.end());
+                line_end.push_back(lines.size());
+                street_ids.insert(street_ids.end(), station.street_ids.begin(), station.street_ids.end());
+                street_end.push_back(street_ids.size());
+            });
+            truncated = rest != end;
+        }
+
+        // Local ids are numbered in order of first occurrence, so interning them in id
+        // order continues the global numbering exactly where the previous shard left it.
+        void replay(Scanner& scanner) {
+            Dictionary& global = scanner.dictionary();
+            std::vector<int> type_ids = intern_all(global.types, types);
+            std::vector<int> route_ids = intern_all(global.routes, routes);
+            std::vector<int> street_map = intern_all(global.streets, streets);
+            std::vector<int> line_ids (dictionary.lines.size());
+            for (int line = 0; line < int(line_ids.size()); ++line) {
+                line_ids[line] = global.lines.intern(type_ids[dictionary.line_type(line)], route_ids[dictionary.line_route(line)]);
+            }
+
+            Station station;
+            std::uint32_t line = 0, street = 0;
+            for (std::size_t i = 0; i < number.size(); ++i) {
+                station.number = number[i];
+                station.type = types[type[i]];
+                station.type_id = type_ids[type[i]];
+                station.coords = coords[i];
+                station.routes.clear();
+                station.lines.clear();
+                for (; line < line_end[i]; ++line) {
+                    station.routes.push_back(routes[dictionary.line_route(lines[line])]);
+                    station.lines.push_back(line_ids[lines[line]]);
+                }
+                station.streets.clear();
+                station.street_ids.clear();
+                for (; street < street_end[i]; ++street) {
+                    station.streets.push_back(streets[street_ids[street]]);
+                    station.street_ids.push_back(street_map[street_ids[street]]);
+                }
+                scanner.dispatch(station);
+            }
+        }
+
+        static void remember(std::vector<std::string_view>& names, int id, std::string_view name) {
+            if (id == int(names.size())) {
+                names.push_back(name);
+            }
+        }
+
+        static std::vector<int> intern_all(Interner& interner, const std::vector<std::string_view>& names) {
+            std::vector<int> ids;
+            ids.reserve(names.size());
+            for (std::string_view name : names) {
+                ids.push_back(interner.intern(name));
+            }
+            return ids;
+        }
+    };
+
+    MappedFile file_;
+    unsigned threads_;
+    bool truncated_ = false;
+
+    // Shard starts at the first open tag after every 1/n of the file; a few shards per
+    // thread keep the threads busy when records are unevenly sized.
+    std::vector<char*> shard_bounds() {
+        const std::string_view open_tag = station_open_tag;
+        char* begin = file_.data();
+        char* end = begin + file_.size();
+        std::size_t n = std::max<std::size_t>(1, std::min<std::size_t>(threads_*4, file_.size() >> 16));
+        std::vector<char*> bounds {begin};
+        for (std::size_t k = 1; k < n; ++k) {
+            char* from = std::max(bounds.back(), begin + file_.size()/n*k);
+            char* start = std::search(from, end, open_tag.begin(), open_tag.end());
+            if (start != bounds.back()) {
+                bounds.push_back(start);
+            }
+        }
+        if (bounds.back() != end) {
+            bounds.push_back(end);
+        }
+        return bounds;
+    }
+};
+
+#endif
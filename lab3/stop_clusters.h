@@ -0,0 +1,193 @@
+#ifndef STOP_CLUSTERS_H
+#define STOP_CLUSTERS_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include "scan.h"
+#include "geo.h"
+#include "kdtree.h"
+#include "disjoint_sets.h"
+#include "station_coords.h"
+
+// Merges records of one physical stop: stations closer than the radius end up in the same
+// cluster, transitively. Candidates come from a hash grid over the unit vectors with cells
+// one radius wide, so each station only looks at the 27 cells around it.
+//
+// Clusters are numbered in order of their first station in the scan, which also stands in
+// for the whole cluster: its number, type and position are the canonical stop. run()
+// replays one station per cluster carrying every line and street of its members, each
+// once. Members may be of different types, so the lines are the only faithful record of
+// what stops there; type and routes alone cannot be resolved back to them.
+class StopClusters : public Aggregator {
+public:
+    StopClusters(const Dictionary& dictionary, double meters)
+            : dictionary_(dictionary)
+            , meters_(meters) {}
+
+    void consume(const Station& station) override {
+        numbers_.push_back(station.number);
+        types_.push_back(station.type_id);
+        coords_.push_back(station.coords);
+        lines_.insert(lines_.end(), station.lines.begin(), station.lines.end());
+        line_end_.push_back(lines_.size());
+        streets_.insert(streets_.end(), station.street_ids.begin(), station.street_ids.end());
+        street_end_.push_back(streets_.size());
+        built_ = false;
+    }
+
+    void build() {
+        int n = numbers_.size();
+        double r2 = meters_to_chord2(meters_);
+        double cell = std::sqrt(r2);
+        DisjointSets sets (n);
+        std::unordered_map<Cell, int, CellHash> heads;
+        std::vector<int> next (n, -1);
+        std::vector<Vec3> units;
+        units.reserve(n);
+        for (int s = 0; s < n && r2 > 0; ++s) {
+            units.push_back(unit_vector(coords_[s]));
+            Cell home = cell_of(units[s], cell);
+            for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                for (std::int64_t dy = -1; dy <= 1; ++dy) {
+                    for (std::int64_t dz = -1; dz <= 1; ++dz) {
+                        auto it = heads.find(Cell {home.x + dx, home.y + dy, home.z + dz});
+                        for (int t = it == heads.end() ? -1 : it->second; t >= 0; t = next[t]) {
+                            if (dist2(units[s], units[t]) <= r2) {
+                                sets.unite(s, t);
+                            }
+                        }
+                    }
+                }
+            }
+            auto [it, inserted] = heads.emplace(home, s);
+            if (!inserted) {
+                next[s] = it->second;
+                it->second = s;
+            }
+        }
+
+        cluster_.assign(n, -1);
+        first_.clear();
+        std::vector<int> id_of_root (n, -1);
+        for (int s = 0; s < n; ++s) {
+            int& id = id_of_root[sets.find(s)];
+            if (id < 0) {
+                id = first_.size();
+                first_.push_back(s);
+            }
+            cluster_[s] = id;
+        }
+        built_ = true;
+    }
+
+    int n_stations() const {
+        return numbers_.size();
+    }
+
+    int size() {
+        ensure_built();
+        return first_.size();
+    }
+
+    // Canonical stop of a station, by index in scan order.
+    int cluster(int station) {
+        ensure_built();
+        return cluster_[station];
+    }
+
+    // Number of the station that represents a cluster.
+    int number(int cluster) {
+        ensure_built();
+        return numbers_[first_[cluster]];
+    }
+
+    void run(Scanner& scanner) {
+        ensure_built();
+        std::vector<std::vector<int>> members (first_.size());
+        for (int s = 0; s < int(cluster_.size()); ++s) {
+            members[cluster_[s]].push_back(s);
+        }
+        Station station;
+        for (int c = 0; c < int(first_.size()); ++c) {
+            int first = first_[c];
+            station.number = numbers_[first];
+            station.type_id = types_[first];
+            station.type = dictionary_.types.name(station.type_id);
+            station.coords = coords_[first];
+            station.lines.clear();
+            station.street_ids.clear();
+            for (int s : members[c]) {
+                for (std::uint32_t i = s ? line_end_[s - 1] : 0; i < line_end_[s]; ++i) {
+                    add_once(station.lines, lines_[i]);
+                }
+                for (std::uint32_t i = s ? street_end_[s - 1] : 0; i < street_end_[s]; ++i) {
+                    add_once(station.street_ids, streets_[i]);
+                }
+            }
+            station.routes.clear();
+            for (int line : station.lines) {
+                station.routes.push_back(dictionary_.routes.name(dictionary_.line_route(line)));
+            }
+            station.streets.clear();
+            for (int street : station.street_ids) {
+                station.streets.push_back(dictionary_.streets.name(street));
+            }
+            scanner.dispatch(station);
+        }
+    }
+
+private:
+    struct Cell {
+        std::int64_t x;
+        std::int64_t y;
+        std::int64_t z;
+
+        friend bool operator==(const Cell& c1, const Cell& c2) {
+            return c1.x == c2.x && c1.y == c2.y && c1.z == c2.z;
+        }
+    };
+
+    struct CellHash {
+        std::size_t operator()(const Cell& c) const {
+            std::uint64_t h = std::uint64_t(c.x)*0x9e3779b97f4a7c15ull;
+            h ^= std::uint64_t(c.y)*0xc2b2ae3d27d4eb4full + (h << 6) + (h >> 2);
+            h ^= std::uint64_t(c.z)*0x165667b19e3779f9ull + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    const Dictionary& dictionary_;
+    double meters_;
+    std::vector<int> numbers_;
+    std::vector<int> types_;
+    std::vector<std::pair<double, double>> coords_;
+    std::vector<std::uint32_t> line_end_;
+    std::vector<int> lines_;
+    std::vector<std::uint32_t> street_end_;
+    std::vector<int> streets_;
+    std::vector<int> cluster_;
+    std::vector<int> first_;
+    bool built_ = false;
+
+    void ensure_built() {
+        if (!built_) {
+            build();
+        }
+    }
+
+    static Cell cell_of(const Vec3& p, double cell) {
+        return Cell {std::int64_t(std::floor(p[0]/cell)), std::int64_t(std::floor(p[1]/cell)), std::int64_t(std::floor(p[2]/cell))};
+    }
+
+    static void add_once(std::vector<int>& ids, int id) {
+        if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef STREET_NORMALIZER_H
+#define STREET_NORMALIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+
+#include "tokenizer.h"
+
+inline std::vector<std::string> default_street_words() {
+    return {
+        "ул.",
+        "пр.",
+        "улица",
+        "проспект",
+        "проезд",
+        "проспект",
+        "переулок",
+        "пер.",
+        "мост",
+        "аллея",
+        "ш.",
+        "шоссе",
+        "набережная",
+        "наб.",
+        "реки",
+        "р.",
+        "пл.",
+        "площадь",
+        "бульвар",
+        "бул.",
+        "дорога",
+        "дор.",
+        "канала"
+    };
+}
+
+// Shortens street names in one left-to-right pass over the UTF-8 bytes. Whitespace runs
+// and street-type words are cut out (at each position the earliest listed word wins, as
+// with a regex alternation) and the remaining pieces are joined with single spaces.
+// "N-M-я линии" (optionally followed by " В.О.") is expanded to "N-я линия" and "M-я линия".
+class StreetNormalizer {
+public:
+    StreetNormalizer() : StreetNormalizer(default_street_words()) {}
+
+    explicit StreetNormalizer(const std::vector<std::string>& words) {
+        for (const std::string& word : words) {
+            add_word(word);
+        }
+    }
+
+    // One word per line; blank lines are skipped.
+    static StreetNormalizer load(std::istream& in) {
+        std::vector<std::string> words;
+        for (std::string line; std::getline(in, line);) {
+            std::string_view word = trim(line);
+            if (!word.empty()) {
+                words.emplace_back(word);
+            }
+        }
+        return StreetNormalizer(words);
+    }
+
+    void add_word(std::string_view word) {
+        if (word.empty()) {
+            return;
+        }
+        int node = 0;
+        for (char c : word) {
+            unsigned char byte = c;
+            if (next_[node*256 + byte] == 0) {
+                next_[node*256 + byte] = n_nodes();
+                next_.resize(next_.size() + 256, 0);
+                rank_.push_back(-1);
+            }
+            node = next_[node*256 + byte];
+        }
+        if (rank_[node] < 0) {
+            rank_[node] = n_words_;
+        }
+        ++n_words_;
+    }
+
+    void normalize(std::string_view full_street, std::vector<std::string>& out) const {
+        out.clear();
+        if (full_street.empty()) {
+            return;
+        }
+        std::string_view first;
+        std::string_view second;
+        if (match_two_lines(full_street, first, second)) {
+            out.emplace_back(first);
+            out.back() += "-я линия";
+            out.emplace_back(second);
+            out.back() += "-я линия";
+            return;
+        }
+        out.emplace_back();
+        std::string& ans = out.back();
+        std::size_t piece = 0;
+        for (std::size_t i = 0; i < full_street.size();) {
+            std::size_t cut = cut_length(full_street, i);
+            if (cut == 0) {
+                ++i;
+                continue;
+            }
+            append_piece(ans, full_street.substr(piece, i - piece));
+            i += cut;
+            piece = i;
+        }
+        append_piece(ans, full_street.substr(piece));
+    }
+
+private:
+    std::vector<int> next_ = std::vector<int>(256, 0);
+    std::vector<int> rank_ {-1};
+    int n_words_ = 0;
+
+    int n_nodes() const {
+        return rank_.size();
+    }
+
+    static void append_piece(std::string& ans, std::string_view piece) {
+        if (piece.empty()) {
+            return;
+        }
+        if (!ans.empty()) {
+            ans += ' ';
+        }
+        ans += piece;
+    }
+
+    // Length of the separator starting at i, or 0. Whitespace ranks before every word.
+    std::size_t cut_length(std::string_view s, std::size_t i) const {
+        if (is_space(s[i])) {
+            std::size_t j = i;
+            while (j < s.size() && is_space(s[j])) {
+                ++j;
+            }
+            return j - i;
+        }
+        int best_rank = -1;
+        std::size_t best_length = 0;
+        int node = 0;
+        for (std::size_t j = i; j < s.size(); ++j) {
+            node = next_[node*256 + static_cast<unsigned char>(s[j])];
+            if (node == 0) {
+                break;
+            }
+            if (rank_[node] >= 0 && (best_rank < 0 || rank_[node] < best_rank)) {
+                best_rank = rank_[node];
+                best_length = j - i + 1;
+            }
+        }
+        return best_length;
+    }
+
+    static std::size_t digits(std::string_view s, std::size_t i) {
+        std::size_t j = i;
+        while (j < s.size() && s[j] >= '0' && s[j] <= '9') {
+            ++j;
+        }
+        return j - i;
+    }
+
+    static bool match_two_lines(std::string_view s, std::string_view& first, std::string_view& second) {
+        static const std::string_view lines = "-я линии";
+        static const std::string_view island = " В.О.";
+        std::size_t n1 = digits(s, 0);
+        if (n1 == 0 || n1 >= s.size() || s[n1] != '-') {
+            return false;
+        }
+        std::size_t n2 = digits(s, n1 + 1);
+        if (n2 == 0) {
+            return false;
+        }
+        std::string_view rest = s.substr(n1 + 1 + n2);
+        if (rest.substr(0, lines.size()) != lines) {
+            return false;
+        }
+        rest.remove_prefix(lines.size());
+        if (!rest.empty() && rest != island) {
+            return false;
+        }
+        first = s.substr(0, n1);
+        second = s.substr(n1 + 1, n2);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_set>
+
+// Keeps one owned copy of every distinct string and hands out views that stay valid
+// for the lifetime of the pool.
+class StringPool {
+public:
+    std::string_view intern(std::string_view s) {
+        auto it = views_.find(s);
+        if (it != views_.end()) {
+            return *it;
+        }
+        std::string_view view = strings_.emplace_back(s);
+        views_.insert(view);
+        return view;
+    }
+
+    std::size_t size() const {
+        return strings_.size();
+    }
+
+private:
+    std::deque<std::string> strings_;
+    std::unordered_set<std::string_view> views_;
+};
+
+#endif
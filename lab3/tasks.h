@@ -0,0 +1,161 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+
+#include "scan.h"
+#include "street_normalizer.h"
+
+class RouteCounts : public Aggregator {
+public:
+    explicit RouteCounts(const Dictionary& dictionary) : dictionary_(dictionary) {}
+
+    void consume(const Station& station) override {
+        for (int line : station.lines) {
+            if (line >= int(counts_.size())) {
+                counts_.resize(line + 1, 0);
+            }
+            counts_[line]++;
+        }
+    }
+
+    const Dictionary& dictionary() const {
+        return dictionary_;
+    }
+
+    int count(int line) const {
+        return line < int(counts_.size()) ? counts_[line] : 0;
+    }
+
+    std::unordered_map<std::string_view, std::pair<std::string_view, int>> result() const {
+        std::vector<int> best (dictionary_.types.size(), -1);
+        for (int line = 0; line < int(counts_.size()); ++line) {
+            int& champ = best[dictionary_.line_type(line)];
+            if (champ < 0 || counts_[line] > counts_[champ]) {
+                champ = line;
+            }
+        }
+        std::unordered_map<std::string_view, std::pair<std::string_view, int>> ans;
+        for (int type = 0; type < int(best.size()); ++type) {
+            if (best[type] >= 0) {
+                ans[dictionary_.types.name(type)] = std::make_pair(dictionary_.routes.name(dictionary_.line_route(best[type])), counts_[best[type]]);
+            }
+        }
+        return ans;
+    }
+
+private:
+    const Dictionary& dictionary_;
+    std::vector<int> counts_;
+};
+
+class RoutePoints : public Aggregator {
+public:
+    explicit RoutePoints(const Dictionary& dictionary) : dictionary_(dictionary) {}
+
+    void consume(const Station& station) override {
+        for (int line : station.lines) {
+            if (line >= int(points_.size())) {
+                points_.resize(line + 1);
+            }
+            points_[line].push_back(station.coords);
+        }
+    }
+
+    const Dictionary& dictionary() const {
+        return dictionary_;
+    }
+
+    int n_lines() const {
+        return points_.size();
+    }
+
+    const std::vector<std::pair<double, double>>& points(int line) const {
+        return points_[line];
+    }
+
+private:
+    const Dictionary& dictionary_;
+    std::vector<std::vector<std::pair<double, double>>> points_;
+};
+
+class StreetCounts : public Aggregator {
+public:
+    explicit StreetCounts(const Dictionary& dictionary, StreetNormalizer normalizer = StreetNormalizer())
+            : dictionary_(dictionary)
+            , normalizer_(std::move(normalizer)) {}
+
+    void consume(const Station& station) override {
+        for (int street : station.street_ids) {
+            for (int short_street : normalized(street)) {
+                if (short_street >= int(counts_.size())) {
+                    counts_.resize(short_street + 1, 0);
+                }
+                counts_[short_street]++;
+            }
+        }
+    }
+
+    std::pair<std::string_view, int> result() const {
+        if (counts_.empty()) {
+            return std::make_pair(std::string_view(), 0);
+        }
+        int champ = 0;
+        for (int street = 1; street < int(counts_.size()); ++street) {
+            if (counts_[street] > counts_[champ]) {
+                champ = street;
+            }
+        }
+        return std::make_pair(names_.name(champ), counts_[champ]);
+    }
+
+    int n_streets() const {
+        return counts_.size();
+    }
+
+    int count(int street) const {
+        return counts_[street];
+    }
+
+    std::string_view name(int street) const {
+        return names_.name(street);
+    }
+
+private:
+    const Dictionary& dictionary_;
+    StreetNormalizer normalizer_;
+    Interner names_;
+    std::vector<int> counts_;
+    std::vector<std::vector<int>> normalized_;
+    std::vector<bool> done_;
+    std::vector<std::string> short_streets_;
+
+    // Short names counted for a raw street; each distinct raw street is normalized once.
+    const std::vector<int>& normalized(int street) {
+        if (street >= int(done_.size())) {
+            done_.resize(street + 1, false);
+            normalized_.resize(street + 1);
+        }
+        if (!done_[street]) {
+            normalized_[street] = normalize(dictionary_.streets.name(street));
+            done_[street] = true;
+        }
+        return normalized_[street];
+    }
+
+    std::vector<int> normalize(std::string_view full_street) {
+        normalizer_.normalize(full_street, short_streets_);
+        std::vector<int> ans;
+        for (const std::string& short_street : short_streets_) {
+            ans.push_back(names_.intern(short_street));
+        }
+        return ans;
+    }
+};
+
+#endif
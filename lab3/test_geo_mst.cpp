@@ -0,0 +1,110 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "geo_mst.h"
+#include "scan.h"
+#include "station_reader.h"
+#include "tasks.h"
+
+// Checks that boruvka_mst_weight, the dense Prim MST and geo_mst_weight, which picks one of
+// them by size, match the haversine mst_weight of geo.h on the routes of a feed, on random
+// point sets and on grids full of equal distances, including sets above the dense limit
+// that only Boruvka handles in lab3:
+//     test_geo_mst [data.xml]
+// The chord trees are exact, so they may only differ by the rounding of the sums. mst_weight
+// takes 1 - cos, which can be off by 2R*sqrt(eps) metres on a short edge, so it gets that
+// much per edge on top.
+
+const double relative_tolerance = 1e-9;
+const double haversine_edge_tolerance = 2*earth_radius*std::sqrt(2.3e-16);
+
+int checks = 0;
+int failures = 0;
+
+bool expect_near(const std::string& name, std::size_t n, const char* what, double value, double expected, double tolerance) {
+    if (std::abs(value - expected) <= tolerance) {
+        return true;
+    }
+    std::cout.precision(17);
+    std::cout << "FAIL " << name << " (" << n << " points): " << what << " " << value << ", prim " << expected
+              << std::endl;
+    return false;
+}
+
+// mst_weight starts its keys at 1000 km and reads keys[0], so it is only asked about
+// non-empty sets without longer edges.
+void check(const std::string& name, const std::vector<std::pair<double, double>>& points, bool haversine = true) {
+    double prim = prim_mst_weight(StationCoords(points));
+    double boruvka = boruvka_mst_weight(points);
+    double tolerance = relative_tolerance*std::max(1.0, prim);
+    bool ok = expect_near(name, points.size(), "boruvka", boruvka, prim, tolerance);
+    ok &= expect_near(name, points.size(), "geo_mst_weight", geo_mst_weight(points), prim, tolerance);
+    if (haversine && !points.empty()) {
+        ok &= expect_near(name, points.size(), "haversine", mst_weight(points), prim,
+                          tolerance + (points.size() - 1)*haversine_edge_tolerance);
+    }
+    ++checks;
+    failures += !ok;
+}
+
+std::vector<std::pair<double, double>> random_points(int n, double lat, double lon, double spread, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> offset (-spread, spread);
+    std::vector<std::pair<double, double>> points;
+    for (int i = 0; i < n; ++i) {
+        points.emplace_back(lat + offset(rng), lon + offset(rng));
+    }
+    return points;
+}
+
+// rows x cols points a fixed step apart, so most candidate edges tie
+std::vector<std::pair<double, double>> grid_points(int rows, int cols, double lat, double lon, double step) {
+    std::vector<std::pair<double, double>> points;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            points.emplace_back(lat + r*step, lon + c*step);
+        }
+    }
+    return points;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "data.xml";
+
+    Dictionary dictionary;
+    Scanner scanner (dictionary);
+    RoutePoints route_points (dictionary);
+    scanner.add(route_points);
+    StationReader reader (path);
+    if (!reader) {
+        std::cout << "error loading " << path << std::endl;
+        return 1;
+    }
+    reader.run(scanner);
+    for (int line = 0; line < route_points.n_lines(); ++line) {
+        const Dictionary& d = route_points.dictionary();
+        std::string name = std::string(d.types.name(d.line_type(line))) + " " + std::string(d.routes.name(d.line_route(line)));
+        check(name, route_points.points(line));
+    }
+    int feed_checks = checks;
+
+    std::mt19937_64 rng (1);
+    // 4097 and up are past the dense limit, where geo_mst_weight goes through Boruvka
+    for (int n : {0, 1, 2, 3, 10, 100, 1000, 4097, 5000}) {
+        check("random city " + std::to_string(n), random_points(n, 55.75, 37.6, 0.3, rng));
+        check("random wide " + std::to_string(n), random_points(n, 0, 0, 60, rng), false);
+    }
+    check("random block 6000", random_points(6000, 55.75, 37.6, 0.005, rng));
+    std::vector<std::pair<double, double>> duplicates = random_points(50, 55.75, 37.6, 0.01, rng);
+    duplicates.insert(duplicates.end(), duplicates.begin(), duplicates.end());
+    check("duplicated points", duplicates);
+    for (auto [rows, cols] : {std::make_pair(1, 50), std::make_pair(10, 10), std::make_pair(40, 60), std::make_pair(64, 80)}) {
+        check("grid " + std::to_string(rows) + "x" + std::to_string(cols), grid_points(rows, cols, 55.75, 37.6, 0.001));
+    }
+
+    std::cout << checks << " MSTs checked (" << feed_checks << " routes of " << path << "), "
+              << failures << " failed" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "geo.h"
+#include "station_coords.h"
+
+// Checks chord2_kernel, relax_kernel and distances_from against the scalar distance() of
+// geo.h on random coordinates. Built twice, with and without AVX2, so both the vector and
+// the scalar paths of the kernels are covered; the AVX2 build skips itself on CPUs
+// without AVX2.
+//
+// distance() takes 1 - cos of the angles, which loses precision for close points: an
+// error of one ulp in cos moves the distance by about 2R^2 * 1.1e-16 / d metres, 9 mm at
+// d = 1 m. The bound allows that plus 1e-9 of the distance.
+
+const int skip_code = 77;
+
+double error_bound(double meters) {
+    return 1e-9*meters + 2*earth_radius*earth_radius*2.3e-16 / std::max(meters, 1e-3);
+}
+
+int checks = 0;
+int failures = 0;
+double worst = 0;
+
+void check(const std::string& name, double got, double expected) {
+    ++checks;
+    double error = std::abs(got - expected);
+    worst = std::max(worst, error / error_bound(expected));
+    if (!(error <= error_bound(expected))) {
+        if (++failures <= 10) {
+            std::cout.precision(17);
+            std::cout << "FAIL " << name << ": " << got << " vs distance() " << expected << std::endl;
+        }
+    }
+}
+
+void check_set(const std::string& name, const std::vector<std::pair<double, double>>& points, std::mt19937_64& rng) {
+    StationCoords coords (points);
+    int n = coords.size();
+    std::vector<double> chord2 (n);
+    std::vector<double> meters (n);
+    std::uniform_real_distribution<double> unit (0, 1);
+    for (int i = 0; i < n; i += std::max(1, n / 16)) {
+        chord2_kernel(coords.x()[i], coords.y()[i], coords.z()[i], coords.x(), coords.y(), coords.z(), n, chord2.data());
+        distances_from(coords, i, meters.data());
+        for (int j = 0; j < n; ++j) {
+            double expected = distance(points[i], points[j]);
+            check(name + " chord2", chord2_to_meters(chord2[j]), expected);
+            check(name + " distances_from", meters[j], expected);
+        }
+
+        // relaxing random keys must keep the smaller of the key and the kernel's chord
+        std::vector<double> keys (n);
+        for (int j = 0; j < n; ++j) {
+            keys[j] = j % 3 ? 4*unit(rng) : std::numeric_limits<double>::infinity();
+        }
+        std::vector<double> relaxed = keys;
+        relax_kernel(coords.x()[i], coords.y()[i], coords.z()[i], coords.x(), coords.y(), coords.z(), n, relaxed.data());
+        for (int j = 0; j < n; ++j) {
+            ++checks;
+            if (relaxed[j] != std::min(keys[j], chord2[j]) && ++failures <= 10) {
+                std::cout << "FAIL " << name << " relax at " << j << std::endl;
+            }
+        }
+    }
+}
+
+std::vector<std::pair<double, double>> random_points(int n, double lat, double lon, double spread, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> offset (-spread, spread);
+    std::vector<std::pair<double, double>> points;
+    for (int i = 0; i < n; ++i) {
+        points.emplace_back(std::clamp(lat + offset(rng), -90.0, 90.0), lon + offset(rng));
+    }
+    return points;
+}
+
+int main() {
+#ifdef __AVX2__
+#if defined(__GNUC__) || defined(__clang__)
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma")) {
+        std::cout << "AVX2 is not supported on this CPU, skipping" << std::endl;
+        return skip_code;
+    }
+#endif
+    std::cout << "AVX2 kernels" << std::endl;
+#else
+    std::cout << "scalar kernels" << std::endl;
+#endif
+    std::mt19937_64 rng (1);
+    // sizes around multiples of the vector width, to cover the scalar tails
+    for (int n : {1, 3, 4, 5, 7, 8, 9, 64, 257, 1000}) {
+        check_set("city " + std::to_string(n), random_points(n, 55.75, 37.6, 0.3, rng), rng);
+        check_set("street " + std::to_string(n), random_points(n, 55.75, 37.6, 0.001, rng), rng);
+        check_set("globe " + std::to_string(n), random_points(n, 0, 0, 180, rng), rng);
+    }
+
+    std::cout << checks << " distances checked, " << failures << " failed, worst error "
+              << worst << " of the bound" << std::endl;
+    return failures ? 1 : 0;
+}
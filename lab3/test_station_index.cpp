@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "geo.h"
+#include "scan.h"
+#include "station_index.h"
+#include "station_reader.h"
+
+// Checks StationIndex::nearest and within against a brute-force distance() scan over the
+// stations of a feed, with and without a type filter:
+//     test_station_index [data.xml]
+// The index measures chords and distance() takes 1 - cos, so the two may disagree by the
+// rounding of the latter, the bound of test_station_coords; stations closer to the edge of
+// a radius than that may fall either way.
+
+double tolerance(double meters) {
+    return 1e-9*meters + 2*earth_radius*earth_radius*2.3e-16 / std::max(meters, 1e-3);
+}
+
+int checks = 0;
+int failures = 0;
+
+void fail(const std::string& what) {
+    if (++failures <= 10) {
+        std::cout << "FAIL " << what << std::endl;
+    }
+}
+
+struct Query {
+    std::pair<double, double> point;
+    int type;
+};
+
+// (distance, station) of every station of the type, closest first.
+std::vector<std::pair<double, int>> brute_force(const StationIndex& index, const Query& query) {
+    std::vector<std::pair<double, int>> ans;
+    for (int s = 0; s < index.size(); ++s) {
+        if (query.type < 0 || index.type(s) == query.type) {
+            ans.emplace_back(distance(query.point, index.coords(s)), s);
+        }
+    }
+    std::sort(ans.begin(), ans.end());
+    return ans;
+}
+
+std::string describe(const Query& query) {
+    return "(" + std::to_string(query.point.first) + ", " + std::to_string(query.point.second) + ") type "
+            + std::to_string(query.type);
+}
+
+void check_hit(const StationIndex& index, const Query& query, const StationHit& hit) {
+    ++checks;
+    double expected = distance(query.point, index.coords(hit.station));
+    if (std::abs(hit.meters - expected) > tolerance(expected)) {
+        fail(describe(query) + ": station " + std::to_string(index.number(hit.station)) + " at "
+             + std::to_string(hit.meters) + " m, distance() says " + std::to_string(expected));
+    }
+    if (query.type >= 0 && index.type(hit.station) != query.type) {
+        fail(describe(query) + ": station " + std::to_string(index.number(hit.station)) + " of another type");
+    }
+}
+
+void check_nearest(const StationIndex& index, const Query& query, int k, const std::vector<std::pair<double, int>>& expected) {
+    std::vector<StationHit> hits = index.nearest(query.point, k, query.type);
+    ++checks;
+    if (int(hits.size()) != std::min<int>(k, expected.size())) {
+        fail(describe(query) + ": " + std::to_string(hits.size()) + " nearest for k = " + std::to_string(k));
+        return;
+    }
+    for (int r = 0; r < int(hits.size()); ++r) {
+        check_hit(index, query, hits[r]);
+        // the r-th hit is as far as the r-th closest station, whichever of equals it is
+        ++checks;
+        if (std::abs(hits[r].meters - expected[r].first) > tolerance(expected[r].first)) {
+            fail(describe(query) + ": nearest #" + std::to_string(r) + " at " + std::to_string(hits[r].meters)
+                 + " m instead of " + std::to_string(expected[r].first));
+        }
+    }
+}
+
+void check_within(const StationIndex& index, const Query& query, double meters, const std::vector<std::pair<double, int>>& expected) {
+    std::vector<StationHit> hits = index.within(query.point, meters, query.type);
+    std::vector<bool> found (index.size(), false);
+    for (int r = 0; r < int(hits.size()); ++r) {
+        check_hit(index, query, hits[r]);
+        found[hits[r].station] = true;
+        ++checks;
+        if (r > 0 && hits[r].meters < hits[r - 1].meters) {
+            fail(describe(query) + ": within not ordered by distance");
+        }
+    }
+    for (const auto& [d, s] : expected) {
+        ++checks;
+        if (d < meters - tolerance(d) && !found[s]) {
+            fail(describe(query) + ": station " + std::to_string(index.number(s)) + " at " + std::to_string(d)
+                 + " m missing within " + std::to_string(meters));
+        } else if (d > meters + tolerance(d) && found[s]) {
+            fail(describe(query) + ": station " + std::to_string(index.number(s)) + " at " + std::to_string(d)
+                 + " m reported within " + std::to_string(meters));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "data.xml";
+
+    Dictionary dictionary;
+    Scanner scanner (dictionary);
+    StationIndex index;
+    scanner.add(index);
+    StationReader reader (path);
+    if (!reader) {
+        std::cout << "error loading " << path << std::endl;
+        return 1;
+    }
+    reader.run(scanner);
+    index.build();
+
+    std::mt19937_64 rng (1);
+    std::uniform_int_distribution<int> station (0, index.size() - 1);
+    std::uniform_int_distribution<int> type (-1, dictionary.types.size() - 1);
+    std::uniform_real_distribution<double> offset (-0.05, 0.05);
+    std::vector<Query> queries;
+    for (int q = 0; q < 300; ++q) {
+        // around stations, on stations and off in the sticks
+        std::pair<double, double> at = index.coords(station(rng));
+        if (q % 3 == 0) {
+            at.first += offset(rng);
+            at.second += offset(rng);
+        } else if (q % 3 == 2) {
+            at.first += 20*offset(rng);
+            at.second += 20*offset(rng);
+        }
+        queries.push_back(Query {at, type(rng)});
+    }
+
+    for (const Query& query : queries) {
+        std::vector<std::pair<double, int>> expected = brute_force(index, query);
+        for (int k : {0, 1, 5, 40}) {
+            check_nearest(index, query, k, expected);
+        }
+        for (double meters : {0.0, 50.0, 300.0, 2000.0}) {
+            check_within(index, query, meters, expected);
+        }
+    }
+    check_nearest(index, Query {index.coords(0), -1}, index.size() + 10, brute_force(index, Query {index.coords(0), -1}));
+
+    std::cout << checks << " hits checked on " << index.size() << " stations of " << path << ", "
+              << failures << " failed" << std::endl;
+    return failures ? 1 : 0;
+}
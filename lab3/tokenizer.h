@@ -0,0 +1,111 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string_view>
+#include <charconv>
+#include <stdexcept>
+#include <utility>
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+inline std::string_view trim_left(std::string_view s) {
+    std::size_t i = 0;
+    while (i < s.size() && is_space(s[i])) {
+        ++i;
+    }
+    return s.substr(i);
+}
+
+inline std::string_view trim_right(std::string_view s) {
+    std::size_t n = s.size();
+    while (n > 0 && is_space(s[n - 1])) {
+        --n;
+    }
+    return s.substr(0, n);
+}
+
+inline std::string_view trim(std::string_view s) {
+    return trim_right(trim_left(s));
+}
+
+// Calls f(token) for every non-empty piece of s between delimiters.
+template<class F>
+void for_each_token(std::string_view s, char delim, F f) {
+    std::size_t start = 0;
+    while (start <= s.size()) {
+        std::size_t end = s.find(delim, start);
+        if (end == std::string_view::npos) {
+            end = s.size();
+        }
+        if (end > start) {
+            f(s.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+}
+
+inline std::string_view first_token(std::string_view s, char delim) {
+    std::size_t start = 0;
+    while (start < s.size() && s[start] == delim) {
+        ++start;
+    }
+    std::size_t end = s.find(delim, start);
+    return s.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+}
+
+// Same pieces as splitting on "\s*,\s*": whitespace is dropped only next to a comma.
+template<class F>
+void for_each_list_item(std::string_view s, F f) {
+    bool first = true;
+    for (std::size_t start = 0; start <= s.size();) {
+        std::size_t end = s.find(',', start);
+        bool last = end == std::string_view::npos;
+        std::string_view item = s.substr(start, last ? std::string_view::npos : end - start);
+        if (!first) {
+            item = trim_left(item);
+        }
+        if (!last) {
+            item = trim_right(item);
+        }
+        if (!item.empty()) {
+            f(item);
+        }
+        if (last) {
+            break;
+        }
+        first = false;
+        start = end + 1;
+    }
+}
+
+inline double parse_double(std::string_view s) {
+    s = trim_left(s);
+    if (!s.empty() && s[0] == '+') {
+        s.remove_prefix(1);
+    }
+    double value;
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec != std::errc()) {
+        throw std::invalid_argument("not a number");
+    }
+    return value;
+}
+
+inline std::pair<double, double> parse_coords(std::string_view s) {
+    std::string_view coords[2];
+    int n = 0;
+    for_each_token(s, ',', [&](std::string_view token) {
+        if (n < 2) {
+            coords[n] = token;
+        }
+        ++n;
+    });
+    if (n < 2) {
+        throw std::invalid_argument("expected two coordinates");
+    }
+    return std::make_pair(parse_double(coords[0]), parse_double(coords[1]));
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+
+inline std::vector<std::string> split(const std::string& s, const std::regex& rgx, bool allow_empty) {
+    std::sregex_token_iterator iter (s.begin(), s.end(), rgx, -1);
+    std::sregex_token_iterator end;
+    std::vector<std::string> res;
+    for (; iter != end; ++iter) {
+        std::string word = *iter;
+        if (!word.empty() || allow_empty) {
+            res.push_back(word);
+        }
+    }
+    return res;
+}
+
+template<class S>
+std::string join(const std::vector<S>& ss, std::string_view delim) {
+    std::string ans;
+    bool fst = true;
+    for (const S& s : ss) {
+        if (fst) {
+            fst = false;
+        } else {
+            ans += delim;
+        }
+        ans += s;
+    }
+    return ans;
+}
+
+template<class K, class V>
+bool comp_by_value(const std::pair<K,V>& p1, const std::pair<K,V>& p2) {
+    return p1.second < p2.second;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef XML_RECORD_H
+#define XML_RECORD_H
+
+#include <string_view>
+#include <algorithm>
+#include <charconv>
+
+#include "scan.h"
+
+inline char* put_utf8(char* out, unsigned long code) {
+    if (code < 0x80) {
+        *out++ = char(code);
+    } else if (code < 0x800) {
+        *out++ = char(0xC0 | (code >> 6));
+        *out++ = char(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *out++ = char(0xE0 | (code >> 12));
+        *out++ = char(0x80 | ((code >> 6) & 0x3F));
+        *out++ = char(0x80 | (code & 0x3F));
+    } else {
+        *out++ = char(0xF0 | (code >> 18));
+        *out++ = char(0x80 | ((code >> 12) & 0x3F));
+        *out++ = char(0x80 | ((code >> 6) & 0x3F));
+        *out++ = char(0x80 | (code & 0x3F));
+    }
+    return out;
+}
+
+// Decodes entities in place. The decoded text is never longer than the raw one,
+// so the result is a view over the start of the same range. Bytes before the first '&'
+// are not written back, so values without entities leave the mapped pages shared with
+// the file instead of turning them into private copies.
+inline std::string_view xml_unescape(char* begin, char* end) {
+    char* first = std::find(begin, end, '&');
+    if (first == end) {
+        return std::string_view(begin, end - begin);
+    }
+    char* out = first;
+    for (char* it = first; it != end; ++it) {
+        if (*it != '&') {
+            *out++ = *it;
+            continue;
+        }
+        char* semicolon = std::find(it, end, ';');
+        if (semicolon == end) {
+            *out++ = *it;
+            continue;
+        }
+        std::string_view entity (it + 1, semicolon - it - 1);
+        if (entity == "lt") {
+            *out++ = '<';
+        } else if (entity == "gt") {
+            *out++ = '>';
+        } else if (entity == "amp") {
+            *out++ = '&';
+        } else if (entity == "quot") {
+            *out++ = '"';
+        } else if (entity == "apos") {
+            *out++ = '\'';
+        } else if (entity.size() > 1 && entity[0] == '#') {
+            bool hex = entity[1] == 'x' || entity[1] == 'X';
+            unsigned long code = 0;
+            std::from_chars(entity.data() + (hex ? 2 : 1), entity.data() + entity.size(), code, hex ? 16 : 10);
+            out = put_utf8(out, code);
+        } else {
+            out = std::copy(it, semicolon + 1, out);
+        }
+        it = semicolon;
+    }
+    return std::string_view(begin, out - begin);
+}
+
+// Calls f(name, value_begin, value_end) for every child element of a flat record body.
+template<class F>
+void for_each_field(char* begin, char* end, F f) {
+    char* pos = begin;
+    while ((pos = std::find(pos, end, '<')) != end) {
+        char* close = std::find(pos, end, '>');
+        if (close == end) {
+            return;
+        }
+        std::string_view tag (pos + 1, close - pos - 1);
+        pos = close + 1;
+        if (tag.empty() || tag[0] == '/' || tag[0] == '?' || tag[0] == '!') {
+            continue;
+        }
+        std::string_view name = tag.substr(0, tag.find_first_of(" \t\r\n/"));
+        if (tag.back() == '/') {
+            f(name, pos, pos);
+            continue;
+        }
+        char* value_end = std::find(pos, end, '<');
+        if (value_end == end) {
+            return;
+        }
+        f(name, pos, value_end);
+        pos = value_end;
+    }
+}
+
+inline void decode_station(char* begin, char* end, Station& station) {
+    std::string_view number;
+    std::string_view routes;
+    std::string_view coordinates;
+    std::string_view location;
+    station.type = {};
+    for_each_field(begin, end, [&](std::string_view name, char* value_begin, char* value_end) {
+        if (name == "number") {
+            number = xml_unescape(value_begin, value_end);
+        } else if (name == "type_of_vehicle") {
+            station.type = xml_unescape(value_begin, value_end);
+        } else if (name == "routes") {
+            routes = xml_unescape(value_begin, value_end);
+        } else if (name == "coordinates") {
+            coordinates = xml_unescape(value_begin, value_end);
+        } else if (name == "location") {
+            location = xml_unescape(value_begin, value_end);
+        }
+    });
+    number = trim(number);
+    station.number = 0;
+    std::from_chars(number.data(), number.data() + number.size(), station.number);
+    get_routes(routes, station.routes);
+    station.coords = get_coords(coordinates);
+    get_streets(location, station.streets);
+}
+
+constexpr std::string_view station_open_tag = "<transport_station>";
+constexpr std::string_view station_close_tag = "</transport_station>";
+
+// Calls f(body_begin, body_end) for every complete record and returns the start of the
+// first incomplete one, or end.
+template<class F>
+char* for_each_record(char* begin, char* end, F f) {
+    const std::string_view open_tag = station_open_tag;
+    const std::string_view close_tag = station_close_tag;
+    char* pos = begin;
+    while (true) {
+        char* record = std::search(pos, end, open_tag.begin(), open_tag.end());
+        if (record == end) {
+            return end;
+        }
+        char* body = record + open_tag.size();
+        char* body_end = std::search(body, end, close_tag.begin(), close_tag.end());
+        if (body_end == end) {
+            return record;
+        }
+        f(body, body_end);
+        pos = body_end + close_tag.size();
+    }
+}
+
+#endif